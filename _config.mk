@@ -15,6 +15,18 @@ flags= -Wall -Wextra -pedantic -O3 # <--- GNU compiler flags
 omp=-fopenmp
 #omp=-qopenmp
 
+#compilation flag for openmp simd directives only (used by HeatBatch)
+ompsimd=-fopenmp-simd
+#ompsimd=-qopenmp-simd
+
+#HeatBatch vectorizes across trials, so target the native instruction set
+#(AVX2/AVX-512) and optionally set the number of lanes, 8 by default
+#flags+= -march=native -DNLANE=8
+
+#count steps, right-hand side evaluations, iterations, and output, and time the
+#phases of every trial, writing telemetry csv files at the end of sweeps
+#flags+= -DTELEMETRY
+
 #-------------------------------------------------------------------------------
 #set the path to libode top directory
 
@@ -3,7 +3,7 @@
 #include "impact_layer.h"
 
 ImpactLayer::ImpactLayer (
-    Grid grid,
+    const Grid &grid,
     Settings stgin,
     double Tbelow_,
     double Tlayer,
@@ -15,26 +15,48 @@ ImpactLayer::ImpactLayer (
 
     //store surface temp before hot layer emplacement
     Tbelow = Tbelow_;
-    //store surface temperature mode
-    Tsmode = Tsmode_;
-
+    //surface temperature mode
+    init_mode(dirTs, fnTs, Tsmode_);
     //initialize the hot upper layer
     init_layer(Tbelow, Tlayer, deplayer);
+}
 
-    //read in surface temperature files for interpolation
-    if ( Tsmode == 2 ) {
-        nTs = read_one_long(dirTs, "n.txt");
-        tTs = new double[nTs];
-        read_double(dirTs, "time", tTs, nTs);
-        Ts = new double[nTs];
-        read_double(dirTs, fnTs, Ts, nTs);
-    }
+void ImpactLayer::reset (
+    Settings stgin,
+    double Tbelow_,
+    double Tlayer,
+    double deplayer,
+    const std::string &dirTs,
+    const std::string &fnTs,
+    int Tsmode_) {
+
+    Heat::reset(stgin);
+    Tbelow = Tbelow_;
+    init_mode(dirTs, fnTs, Tsmode_);
+    init_layer(Tbelow, Tlayer, deplayer);
 }
 
-ImpactLayer::~ImpactLayer () {
+void ImpactLayer::init_mode (const std::string &dirTs, const std::string &fnTs, int Tsmode_) {
+
+    //store surface temperature mode
+    Tsmode = Tsmode_;
+    //radiation to space, absorbing 114 W/m^2
+    if ( Tsmode == 1 ) {
+        stg.radiative = true;
+        stg.emissivity = 1.0;
+        stg.Fabs = 114.0;
+    }
+
+    //share the surface temperature series with every other trial, opening it
+    //only if a reset object doesn't have it already
     if ( Tsmode == 2 ) {
-        delete [] tTs;
-        delete [] Ts;
+        if ( (dirseries != dirTs) || (fnseries != fnTs) ) {
+            Tsseries = SeriesCursor(Series::open(dirTs + "/time", dirTs + "/" + fnTs));
+            dirseries = dirTs;
+            fnseries = fnTs;
+        } else {
+            Tsseries.rewind();
+        }
     }
 }
 
@@ -48,8 +70,8 @@ void ImpactLayer::init_layer (double Tbelow, double Tlayer, double deplayer) {
             //below the hot layer
             this->set_sol(i,
                 f_geotherm(Tbelow,
-                    f_qgeo(stg.qgeo0, 0),
-                    f_k(stg.k0, -zc[i] - deplayer),
+                    Heat::f_qgeo(stg.qgeo0, 0),
+                    Heat::f_k(stg.k0, -zc[i] - deplayer),
                     -zc[i] - deplayer
                 )
             );
@@ -57,27 +79,6 @@ void ImpactLayer::init_layer (double Tbelow, double Tlayer, double deplayer) {
     }
 }
 
-double ImpactLayer::f_Stefan_Boltzmann (double Tend, double k, double delz) {
-    //Stefan-Boltzmann constant, SI units
-    double sigma = 5.67e-8;
-    //Newton solve for the appropriate surface temperature
-    double Ts0, Ts1, f, df;
-    Ts0 = INFINITY;
-    Ts1 = Tend;
-    while ( fabs(Ts0 - Ts1)/fabs(Ts1) > 1e-9 ) {
-        //store previous estimate
-        Ts0 = Ts1;
-        //evaluate the function equating surface flux w/ Stefan-Boltzmann
-        f = delz*(sigma*(Ts1*Ts1*Ts1*Ts1) - 114) + k*Ts1 - k*Tend;
-        //evaluate its derivative
-        df = 4*delz*sigma*(Ts1*Ts1*Ts1) + k;
-        //update
-        Ts1 -= f/df;
-    }
-    //return the final surface temperature value
-    return(Ts1);
-}
-
 double ImpactLayer::f_Ts (double t, double Tsa, double Tsb, double Tsc) {
     //normal parameters aren't needed
     (void)Tsa; (void)Tsb; (void)Tsc;
@@ -87,10 +88,10 @@ double ImpactLayer::f_Ts (double t, double Tsa, double Tsb, double Tsc) {
             return( 220.0 );
             break;
         case 1:
-            return( f_Stefan_Boltzmann(get_sol(n-1), k[n], delz[n-1]/2) );
+            return( f_Ts_radiative(get_sol(n-1)) );
             break;
         case 2:
-            return( interp(tTs, Ts, t, nTs) );
+            return( Tsseries(t) );
             break;
         default:
             printf("Erroneous Tsmode value\n");
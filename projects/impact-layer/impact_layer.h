@@ -8,13 +8,15 @@
 #include "grid.h"
 #include "settings.h"
 #include "heat.h"
+#include "series.h"
+#include "heat_kernel.h"
 
 class ImpactLayer : public Heat {
 public:
 
     //!constructs
     ImpactLayer (
-        Grid grid,
+        const Grid &grid,
         Settings stgin,
         double Tbelow_,
         double Tlayer,
@@ -22,18 +24,24 @@ public:
         std::string dirTs,
         std::string fnTs,
         int Tsmode_);
-    //!destructs
-    ~ImpactLayer ();
+
+    //!reinitializes for a new trial on the same grid, as if it had just been constructed (see Heat::reset), keeping the surface temperature series if it's the same one
+    void reset (
+        Settings stgin,
+        double Tbelow_,
+        double Tlayer,
+        double deplayer,
+        const std::string &dirTs,
+        const std::string &fnTs,
+        int Tsmode_);
 
     //!temperature below the hot layer
     double Tbelow;
 
-    //!length of surface temperature arrays
-    long nTs;
-    //!time for surface temperature interpolation
-    double *tTs;
-    //!surface temperatures for interpolation
-    double *Ts;
+    //!surface temperature series, shared by every trial, and this trial's place in it
+    SeriesCursor Tsseries;
+    //!directory and file name of the surface temperature series, empty if it isn't open
+    std::string dirseries, fnseries;
     //!process to use for surface temperature
     /*!
     0 - constant surface temperature of 220 K
@@ -42,19 +50,45 @@ public:
     */
     int Tsmode;
 
+    //!sets the surface temperature mode, opening its series if needed
+    void init_mode (const std::string &dirTs, const std::string &fnTs, int Tsmode_);
+
     //!initializes an upper layer with a uniform temperature
     void init_layer (double Ts, double Tlayer, double depth);
 
-    //!computes a surface temperature for Stefan-Boltzmann radiative flux
-    /*!
-    \param[in] Tend temperature of the surface cell
-    \param[in] k thermal conductivity of the surface cell
-    */
-    double f_Stefan_Boltzmann (double Tend, double k, double delz);
-
     //!surface temperature over time (K)
     double f_Ts (double t, double Tsa, double Tsb, double Tsc);
 
 };
 
+//------------------------------------------------------------------------------
+//surface temperature policies for HeatKernel<..., ImpactLayer>
+
+//!constant surface temperature of 220 K (Tsmode 0)
+class ImpactConstant {
+public:
+    ImpactConstant (ImpactLayer &h) { (void)h; }
+    double Ts (double t, const double *T) { (void)t; (void)T; return(220.0); }
+};
+
+//!surface temperature for Stefan-Boltzmann radiation to space (Tsmode 1), warm started as in Heat::f_Ts_radiative
+typedef SurfaceRadiative ImpactRadiative;
+
+//!surface temperature interpolated from the time series in dirTs/fnTs (Tsmode 2)
+class ImpactSeries {
+public:
+    ImpactSeries (ImpactLayer &h) : hl (&h), tlast (NAN), Tslast (NAN) {}
+    double Ts (double t, const double *T) {
+        (void)T;
+        if ( t != tlast ) {
+            tlast = t;
+            Tslast = hl->Tsseries(t);
+        }
+        return(Tslast);
+    }
+private:
+    ImpactLayer *hl;
+    double tlast, Tslast;
+};
+
 #endif
@@ -8,89 +8,192 @@
 #include "io.h"
 #include "util.h"
 #include "grid.h"
+#include "pool.h"
+#include "sweep.h"
 #include "settings.h"
+#include "scheduler.h"
+#include "checkpoint.h"
+#include "telemetry.h"
+#include "series.h"
+#include "heat_kernel.h"
 #include "impact_layer.h"
 
+//!solver with its surface temperature mode resolved at compile time
+template<class SurfaceBC>
+using ImpactKernel = HeatKernel<SurfaceBC, BottomFlux, ApparentCapacity, ImpactLayer>;
+
+//!integrates one trial with a solver from the mode's pool
+template<class SurfaceBC>
+void run_trial (SolverPool< ImpactKernel<SurfaceBC> > &pool, double depth, double delz0,
+                Settings &stg, double Tbelow, double Tlayer,
+                double deplayer, const std::string &dirTs, const std::string &fnTs,
+                int Tsmode, double timfac, long i, const std::string &dirout, Archive *archive, Writer *writer,
+                TelemetryLog &telemetry) {
+    //reset (or create) this thread's solver
+    ImpactKernel<SurfaceBC> &heat = pool.acquire(depth, delz0, 1, 1e9,
+        stg, Tbelow, Tlayer, deplayer, dirTs, fnTs, Tsmode);
+    heat.set_name(int_to_string(i));
+    heat.set_quiet(true);
+    heat.set_archive(archive);
+    heat.set_writer(writer);
+    //write the cell coordinates
+    GridView zc = heat.grid.get_zc();
+    write_output(archive, writer, dirout, heat.get_name(), "zc", -1, NAN, zc.data(), zc.size());
+    //integration time
+    double tint = timfac*(deplayer*deplayer)/(heat.k[0]/heat.cap[0]);
+    //integrate
+    heat.solve(tint, stg.nsnap, dirout.c_str());
+    telemetry.add(i, 1, omp_get_thread_num(), heat.tel);
+}
+
+//!times the right-hand side of one trial, as a pilot run calibrating the cost of its surface temperature mode
+template<class SurfaceBC>
+double pilot_trial (Grid &grid, Settings &stg, double Tbelow, double Tlayer,
+                    double deplayer, std::string dirTs, std::string fnTs, int Tsmode) {
+    ImpactKernel<SurfaceBC> heat(grid, stg, Tbelow, Tlayer, deplayer, dirTs, fnTs, Tsmode);
+    return( heat.time_rhs(100) );
+}
+
 //!model driver
 int main (int argc, char **argv) {
 
     if ( argc != 3 )
         print_exit("crustal_heat must be given two command line arguments\n  1. path to settings file\n  2. path to output directory");
 
-    //domain size and integration time
-    double depfac = 6; //multiple of impact layer depth for total domain depth
-    double timfac = 12; //multiple of thermal time scale for total integration time
-    int ncell = 240; //number of cells to put in the impact layer
-
-    //parameter ranges
-    std::vector<double> deplayer = logspace(0, 2.69897, 10);
-    std::vector<double> Tsinterp = linspace(0, 2, 3); //false and true
-    std::vector<double> Tlayer = linspace(400, 1200, 5);
-    double Tbelow = 220.0;
+    //surface temperature time series
     std::string fnTs = "1bar100km";
-
     //binary files surface temperature directory
     std::string dirTs = "atmospheric-temperature/reformatted";
 
     //store output directory
     std::string dirout = argv[2];
 
-    //read default settings
-    Settings stg = parse_settings(read_values(argv[1]));
+    //read default settings and the impact layer parameters, some swept
+    Sweep sweep(read_values(argv[1]), {"deplayer", "Tsinterp", "Tlayer", "Tbelow", "depfac", "timfac", "ncell"});
+    Settings &stg = sweep.base;
+    long nparam = sweep.get_ntrial();
 
-    //allocate parameter table
-    long nparam = long(deplayer.size()*Tsinterp.size()*Tlayer.size());
-    double **param = new double*[nparam];
-    for (long i=0; i<nparam; i++) param[i] = new double[3];
+    //open a single output file shared by all trials, if requested
+    Archive *archive = NULL;
+    //(appending when checkpointing, so a restarted run keeps earlier output)
+    if ( stg.archive )
+        archive = new Archive(dirout + "/archive", stg.checkpoint > 0);
+    //write output on a background thread shared by all trials, if requested
+    Writer *writer = NULL;
+    if ( stg.async_write )
+        writer = new Writer(stg.nqueue);
 
-    //fill and write parameter table
+    //write parameter table
     std::string fn = dirout + "/trials.csv";
-    check_file_write(fn.c_str());
-    FILE *ofile = fopen(fn.c_str(), "w");
-    fprintf(ofile, "trial,layer thickness (m),impact atmos temp?,initial layer temperature (K)\n");
-    long unsigned count = 0;
-    for (long i=0; i<long(deplayer.size()); i++) {
-        for (long j=0; j<long(Tsinterp.size()); j++) {
-            for (long k=0; k<long(Tlayer.size()); k++) {
-                //fill a row of the table
-                param[count][0] = deplayer[i];
-                param[count][1] = Tsinterp[j];
-                param[count][2] = Tlayer[k];
-                //write to file
-                fprintf(ofile, "%li,%g,%g,%g\n",
-                    count,
-                    param[count][0],
-                    param[count][1],
-                    param[count][2]);
-                count++;
-            }
+    sweep.write_table(fn);
+    printf("parameter table written to: %s\n", fn.c_str());
+
+    //grid of a trial, the multiple depfac of the impact layer depth with ncell cells in the layer
+    auto trial_depth = [&sweep](long i) { return( sweep.param(i, "depfac")*sweep.param(i, "deplayer") ); };
+    auto trial_delz0 = [&sweep](long i) { return( sweep.param(i, "deplayer")/sweep.param(i, "ncell") ); };
+    auto trial_grid = [&](long i) { return( Grid(trial_depth(i), trial_delz0(i), 1, 1e9) ); };
+    //surface temperature mode: 0 constant, 1 radiative, 2 interpolated from the series
+    auto trial_mode = [&sweep](long i) { return( int(sweep.param(i, "Tsinterp")) ); };
+
+    //predict the cost of each trial from its grid, stable time step, and
+    //integration time, with a cost per unit for each surface temperature mode
+    Scheduler sched(nparam);
+    std::vector<long> pilot(3, -1);
+    SolverPool<Heat> costpool;
+    for (long i=0; i<nparam; i++) {
+        double Tsinterp = sweep.param(i, "Tsinterp");
+        if ( (Tsinterp != 0) && (Tsinterp != 1) && (Tsinterp != 2) )
+            print_exit(("Tsinterp must be 0, 1, or 2, not " + sweep.value(i, "Tsinterp")).c_str());
+        Heat &heat = costpool.acquire(trial_depth(i), trial_delz0(i), 1, 1e9, stg);
+        double deplayer = sweep.param(i, "deplayer");
+        double tint = sweep.param(i, "timfac")*(deplayer*deplayer)/(heat.k[0]/heat.cap[0]);
+        sched.set_cost(i, heat.cost_units(tint), trial_mode(i));
+        if ( pilot[trial_mode(i)] < 0 ) pilot[trial_mode(i)] = i;
+    }
+    //open the series once for every trial of mode 2, held until the end so it
+    //isn't unmapped and mapped again whenever no solver happens to use it
+    std::shared_ptr<const Series> Ts;
+    if ( pilot[2] >= 0 ) {
+        Ts = Series::open(dirTs + "/time", dirTs + "/" + fnTs);
+        printf("surface temperature series %s/%s: %li samples, %s\n", dirTs.c_str(), fnTs.c_str(), Ts->size(), Ts->mapped() ? "memory-mapped" : "read into memory");
+    }
+
+    //calibrate each mode with a pilot run of its first trial
+    for (int m=0; m<3; m++) {
+        long i = pilot[m];
+        if ( i < 0 ) continue;
+        Grid grid = trial_grid(i);
+        double Tbelow = sweep.param(i, "Tbelow"), Tlayer = sweep.param(i, "Tlayer"), deplayer = sweep.param(i, "deplayer");
+        double rate;
+        switch ( m ) {
+            case 0: rate = pilot_trial<ImpactConstant>(grid, stg, Tbelow, Tlayer, deplayer, dirTs, fnTs, m); break;
+            case 1: rate = pilot_trial<ImpactRadiative>(grid, stg, Tbelow, Tlayer, deplayer, dirTs, fnTs, m); break;
+            default: rate = pilot_trial<ImpactSeries>(grid, stg, Tbelow, Tlayer, deplayer, dirTs, fnTs, m);
         }
+        sched.calibrate(m, rate);
+        printf("surface temperature mode %d costs %g s per cell evaluation\n", m, rate);
     }
-    fclose(ofile);
-    printf("parameter table written to: %s\n", fn.c_str());
+
+    //finished trials of a killed run are skipped when checkpointing
+    Manifest *manifest = NULL;
+    if ( stg.checkpoint > 0 )
+        manifest = new Manifest(dirout + "/manifest");
+
+    //performance counters of every trial, if compiled in
+    TelemetryLog telemetry;
 
     printf("beginning parallel integrations with %d threads\n", omp_get_max_threads());
     printf("%li trials to integrate\n", nparam);
-    #pragma omp parallel for schedule(dynamic)
-    for (long i=0; i<nparam; i++) {
-        //create a grid
-        Grid grid(depfac*param[i][0], param[i][0]/double(ncell), 1, 1e9);
-        //write the cell coordinates
-        write_double(dirout + "/" + int_to_string(i) + "_zc", grid.get_zc());
-        //create a solver
-        ImpactLayer heat(grid, stg, Tbelow, param[i][2], param[i][0], dirTs, fnTs, bool(param[i][1]));
-        heat.set_name(int_to_string(i));
-        heat.set_quiet(true);
-        //integration time
-        double tint = timfac*(param[i][0]*param[i][0])/(heat.k[0]/heat.cap[0]);
-        //integrate
-        heat.solve_adaptive(tint, tint*1e-12, stg.nsnap, dirout.c_str());
+    //one solver for each thread and surface temperature mode, reset for each
+    //trial on the same grid as the thread's last trial of that mode
+    SolverPool< ImpactKernel<ImpactConstant> > pool0;
+    SolverPool< ImpactKernel<ImpactRadiative> > pool1;
+    SolverPool< ImpactKernel<ImpactSeries> > pool2;
+    //longest first, with work stealing
+    sched.set_progress(stg.progress);
+    sched.run([&](long i) {
+        if ( manifest && manifest->finished(i) ) return;
+        //parameters of the trial
+        double deplayer = sweep.param(i, "deplayer");
+        double Tlayer = sweep.param(i, "Tlayer");
+        double Tbelow = sweep.param(i, "Tbelow");
+        double timfac = sweep.param(i, "timfac"); //multiple of thermal time scale for total integration time
+        //grid of the trial
+        double depth = trial_depth(i), delz0 = trial_delz0(i);
+        //surface temperature mode
+        int Tsmode = trial_mode(i);
+        //integrate with a solver specialized for the mode
+        switch ( Tsmode ) {
+            case 0:
+                run_trial<ImpactConstant>(pool0, depth, delz0, stg, Tbelow, Tlayer, deplayer, dirTs, fnTs, Tsmode, timfac, i, dirout, archive, writer, telemetry);
+                break;
+            case 1:
+                run_trial<ImpactRadiative>(pool1, depth, delz0, stg, Tbelow, Tlayer, deplayer, dirTs, fnTs, Tsmode, timfac, i, dirout, archive, writer, telemetry);
+                break;
+            default:
+                run_trial<ImpactSeries>(pool2, depth, delz0, stg, Tbelow, Tlayer, deplayer, dirTs, fnTs, Tsmode, timfac, i, dirout, archive, writer, telemetry);
+        }
+        //output has to be on disk before the trial is recorded as finished
+        if ( manifest ) {
+            if ( writer ) writer->flush();
+            if ( archive ) archive->flush();
+            manifest->finish(i);
+        }
         printf("  trial %li finished\n", i);
-    }
+    });
     printf("all trials complete\n\n");
+    sched.print_report();
+    sched.write_report(dirout + "/schedule.csv");
+    if ( TelemetryLog::enabled() ) {
+        telemetry.write_trials(dirout + "/telemetry_trials.csv");
+        telemetry.write_threads(dirout + "/telemetry_threads.csv");
+    }
 
-    for (long i=0; i<nparam; i++) delete [] param[i];
-    delete [] param;
+    //finish writing, then write the archive index
+    if ( writer ) writer->print_counters();
+    delete writer;
+    delete archive;
+    delete manifest;
 
     return(0);
 }
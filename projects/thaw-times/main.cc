@@ -3,110 +3,73 @@
 #include <vector>
 #include <iostream>
 
-#include "omp.h"
-
 #include "io.h"
-#include "util.h"
-#include "grid.h"
 #include "heat.h"
+#include "sweep.h"
+#include "writer.h"
+#include "archive.h"
 #include "settings.h"
+#include "heat_batch.h"
+#include "heat_linear.h"
 
 //!model driver
 int main (int argc, char **argv) {
 
-    //output csv
-    std::string fn;
-    FILE *ofile;
-    //indices & counters
-    long long unsigned i,ia,ib,ic,id,count,nparam;
-    //parameter vectors
-    std::vector<double> k0, qgeo0, Tsa, Tsb;
-    //parameter range specifications
-    double k0a = 1, k0b = 7; int k0n = 7;
-    double qgeo0a = 0.01, qgeo0b = 0.1; int qgeo0n = 10;
-    double Tsaa = 200, Tsab = 260; int Tsan = 30;
-    double Tsba = 280, Tsbb = 320; int Tsbn = 20;
-    //parameter table
-    double **param;
-
     if ( argc != 3 )
         print_exit("thaw_times must be given two command line arguments\n  1. path to default settings file\n  2. path to output directory");
 
     //store output directory
     std::string dirout = argv[2];
 
-    //read settings
-    Settings stg = parse_settings(read_values(argv[1]));
+    //read settings, with the swept parameter ranges
+    Sweep sweep(read_values(argv[1]));
+    Settings &stg = sweep.base;
 
-    //create grid
-    Grid grid(stg.depth, stg.delz0, stg.delzfrac, stg.delzmax);
-    if ( stg.save_grid )
-        grid.save(dirout);
+    //open a single output file shared by all trials, if requested
+    Archive *archive = NULL;
+    //(appending when checkpointing, so a restarted run keeps earlier output)
+    if ( stg.archive )
+        archive = new Archive(dirout + "/archive", stg.checkpoint > 0);
+    //write output on a background thread shared by all trials, if requested
+    Writer *writer = NULL;
+    if ( stg.async_write )
+        writer = new Writer(stg.nqueue);
 
-    //create parameter ranges
-    k0 = linspace(k0a, k0b, k0n);
-    qgeo0 = linspace(qgeo0a, qgeo0b, qgeo0n);
-    Tsa = linspace(Tsaa, Tsab, Tsan);
-    Tsb = linspace(Tsba, Tsbb, Tsbn);
+    //write parameter combinations to a file
+    std::string fn = dirout + "/trials.csv";
+    sweep.write_table(fn);
+    printf("parameter table written to: %s\n", fn.c_str());
 
-    //allocate parameter table
-    nparam = k0.size()*qgeo0.size()*Tsa.size()*Tsb.size();
-    param = new double*[nparam];
-    for (i=0; i<nparam; i++) param[i] = new double[4];
+    //thaw times go into the sweep's summary table, so trials don't need
+    //files of their own (trial_files = false)
+    sweep.add_reducer([](const Settings &s, long long i) {
+        (void)i;
+        return( Reducer("tthaw", reduce_crossing, event_Tmin, s.Tf, 1) );
+    });
 
-    //fill parameter table and write parameter combinations to a file
-    fn = dirout + "/trials.csv";
-    check_file_write(fn.c_str());
-    ofile = fopen(fn.c_str(), "w");
-    fprintf(ofile, "trial,k0,qgeo0,Tsa,Tsb\n");
-    count = 0;
-    for (ia=0; ia<k0.size(); ia++) {
-        for (ib=0; ib<qgeo0.size(); ib++) {
-            for (ic=0; ic<Tsa.size(); ic++) {
-                for (id=0; id<Tsb.size(); id++) {
-                    //fill in row of table
-                    param[count][0] = k0[ia];
-                    param[count][1] = qgeo0[ib];
-                    param[count][2] = Tsa[ic];
-                    param[count][3] = Tsb[id];
-                    //write to file
-                    fprintf(ofile, "%lli,%g,%g,%g,%g\n",
-                        count,
-                        param[count][0],
-                        param[count][1],
-                        param[count][2],
-                        param[count][3]);
-                    //increment
-                    count++;
-                }
-            }
+    //integrate every trial, stopping each when the whole column has thawed
+    //(the explicit solver batches trials sharing k0, and therefore their
+    //stable time step, and without latent heat, trials differing only in
+    //Tsa, Tsb, and qgeo0 are superposed from one integration)
+    sweep.run(dirout, archive, writer,
+        [](Heat &heat, long long i) {
+            (void)i;
+            heat.add_event(Event(event_Tmin, heat.stg.Tf, 1, true));
+        },
+        [](HeatBatch &batch, long w, long long i) {
+            (void)i;
+            batch.add_event(w, Event(event_Tmin, batch.stg[w].Tf, 1, true));
+        },
+        [](HeatLinear &lin, long w, long long i) {
+            (void)i;
+            lin.add_event(w, Event(event_Tmin, lin.stgs[w].Tf, 1, true));
         }
-    }
-    //close the csv
-    fclose(ofile);
-    printf("parameter table written to: %s\n", fn.c_str());
-
-    printf("beginning parallel integrations with %d threads\n", omp_get_max_threads());
-    #pragma omp parallel for schedule(dynamic)
-    for (long long unsigned i=0; i<nparam; i++) {
-        //copy settings
-        Settings stgi = copy_settings(stg);
-        //edit parameters
-        stgi.k0 = param[i][0];
-        stgi.qgeo0 = param[i][1];
-        stgi.Tsa = param[i][2];
-        stgi.Tsb = param[i][3];
-        //create solver
-        Heat heat(grid, stgi);
-        heat.set_quiet(true);
-        heat.set_name(int_to_string(i));
-        //integrate
-        double tint = stgi.tint*stgi.tunit;
-        heat.solve_adaptive(tint, tint*1e-12, stgi.nsnap, dirout.c_str());
-    }
+    );
 
-    for (i=0; i<nparam; i++) delete [] param[i];
-    delete [] param;
+    //finish writing, then write the archive index
+    if ( writer ) writer->print_counters();
+    delete writer;
+    delete archive;
 
     return(0);
 }
@@ -1,33 +1,47 @@
 from numpy import *
 from pandas import read_csv
 from os import listdir
-from os.path import join
-from scipy.interpolate import CubicSpline
-import matplotlib.pyplot as plt
+from os.path import join, isfile
+from sys import path
+path.append(join('..', '..', 'scripts'))
+from reading import readindex, readrecord
 
 #-------------------------------------------------------------------------------
 #INPUT
 
 dirbatch = 'results'
 
+fntrials = 'trials.csv'
+
+fnsummary = 'summary.csv'
+
 fnout = 'thaw_times.csv'
 
 #-------------------------------------------------------------------------------
 #MAIN
 
-#read the trials csv
-trials = read_csv(join(dirbatch, fntrials), index_col=0)
-
-#find thaw times
-trials['t'] = nan
-for idx in trials.index:
-    t = fromfile(join(dirbatch, str(idx) + '_t'))
-    minT = fromfile(join(dirbatch, str(idx) + '_minT'))
-    s = CubicSpline(t, minT - 273)
-    try:
-        trials.at[idx,'t'] = s.roots()[0]
-    except IndexError:
+if isfile(join(dirbatch, fnsummary)):
+    #thaw times were reduced during the sweep (nan if never thawed)
+    trials = read_csv(join(dirbatch, fnsummary), index_col=0)
+    trials = trials.rename(columns={'tthaw': 't'})
+    for idx in trials.index[isnan(trials['t'].values)]:
         print(idx)
+else:
+    #read the trials csv
+    trials = read_csv(join(dirbatch, fntrials), index_col=0)
+
+    #read thaw times, located during the integrations (nan if never thawed)
+    trials['t'] = nan
+    fnarch = join(dirbatch, 'archive')
+    if isfile(fnarch):
+        index = readindex(fnarch)
+    for idx in trials.index:
+        if isfile(fnarch):
+            trials.at[idx,'t'] = readrecord(fnarch, index, str(idx), 'events')[0]
+        else:
+            trials.at[idx,'t'] = fromfile(join(dirbatch, str(idx) + '_events'))[0]
+        if isnan(trials.at[idx,'t']):
+            print(idx)
 
 #write to file
 trials.to_csv(fnout)
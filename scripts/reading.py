@@ -1,8 +1,9 @@
 from numpy import *
-from os import listdir
-from os.path import join
+from os import listdir, stat
+from os.path import join, isfile
+from struct import unpack
 
-__all__ = ['isint', 'readvar', 'readsnaps']
+__all__ = ['isint', 'readvar', 'readsnaps', 'readindex', 'readrecord']
 
 def isint(x):
     try:
@@ -12,9 +13,115 @@ def isint(x):
     else:
         return(True)
 
-readvar = lambda resdir, fn: fromfile(join(resdir, fn))
+#-------------------------------------------------------------------------------
+#archive files (see src/archive.h for the format)
+
+def _unpackheader(b, i):
+    #name, variable, snap number, snap time, number of values
+    n, = unpack('<i', b[i:i+4]); i += 4
+    name = b[i:i+n].decode(); i += n
+    n, = unpack('<i', b[i:i+4]); i += 4
+    var = b[i:i+n].decode(); i += n
+    isnap, t, size = unpack('<qdq', b[i:i+24]); i += 24
+    return(name, var, isnap, t, size, i)
+
+def _readheader(f):
+    #read the header fields of a RECD block or INDX entry at the file position
+    n, = unpack('<i', f.read(4))
+    name = f.read(n).decode()
+    n, = unpack('<i', f.read(4))
+    var = f.read(n).decode()
+    isnap, t, size = unpack('<qdq', f.read(24))
+    return(name, var, isnap, t, size)
+
+def readindex(fn):
+    '''Reads the index of an archive file, returning a dictionary mapping
+    (name, variable, snap number) to (snap time, number of values, byte
+    offset of the values). The snap number is -1 for variables that aren't
+    snaps. Only the final INDX block is read if the archive was closed, and
+    only the block headers otherwise, so the values are never read.'''
+    index = {}
+    with open(fn, 'rb') as f:
+        assert f.read(8) == b'CRUSTAL1', 'not an archive file: ' + fn
+        #use the final index if the archive was closed
+        end = f.seek(0, 2)
+        if end >= 24:
+            f.seek(end - 16)
+            i, tag = unpack('<q8s', f.read(16))
+            if (tag == b'CRUSTEND') and (8 <= i < end - 16):
+                f.seek(i)
+                b = f.read(end - 16 - i)
+                nrec, = unpack('<q', b[12:20])
+                i = 20
+                for _ in range(nrec):
+                    off, = unpack('<q', b[i:i+8])
+                    name, var, isnap, t, size, i = _unpackheader(b, i+8)
+                    #the values follow the block's header, which has the same fields
+                    j = off + 12 + 8 + len(name.encode()) + len(var.encode()) + 24
+                    index[(name, var, isnap)] = (t, size, j)
+                return(index)
+        #otherwise scan the blocks of an archive that wasn't closed, seeking past their contents
+        i = 8
+        while i + 12 <= end:
+            f.seek(i)
+            tag, n = unpack('<4sq', f.read(12))
+            if i + 12 + n > end:
+                break
+            if tag == b'RECD':
+                name, var, isnap, t, size = _readheader(f)
+                index[(name, var, isnap)] = (t, size, f.tell())
+            i += 12 + n
+    return(index)
+
+#indices of archives already read, with the modification time and size of the
+#file when they were read and the map from output file names to records
+_indexcache = {}
+
+def _cachedindex(fn):
+    #read an archive's index only if it changed since the last read
+    st = stat(fn)
+    stamp = (st.st_mtime_ns, st.st_size)
+    if (fn not in _indexcache) or (_indexcache[fn][0] != stamp):
+        index = readindex(fn)
+        _indexcache[fn] = (stamp, index, {})
+    return(_indexcache[fn][1], _indexcache[fn][2])
+
+def readrecord(fn, index, name, var, isnap=-1):
+    '''Reads the values of one record from an archive file'''
+    t, size, off = index[(name, var, isnap)]
+    return(fromfile(fn, dtype='<f8', count=size, offset=off))
+
+def _archivekey(resdir, fn):
+    #map a file name written without an archive to its record
+    index, keys = _cachedindex(join(resdir, 'archive'))
+    if not keys:
+        for key in index:
+            name, var, isnap = key
+            if name == 'grid':
+                kfn = var
+            elif isnap < 0:
+                kfn = name + '_' + var
+            else:
+                kfn = name + '_' + var + '_' + str(isnap)
+            keys[kfn] = key
+    return(index, keys[fn])
+
+#-------------------------------------------------------------------------------
+
+def readvar(resdir, fn):
+    #read from the archive if the output was written to one
+    if not isfile(join(resdir, fn)) and isfile(join(resdir, 'archive')):
+        index, key = _archivekey(resdir, fn)
+        return(readrecord(join(resdir, 'archive'), index, *key))
+    return(fromfile(join(resdir, fn)))
 
 def readsnaps(resdir, varname):
+    #read from the archive if the output was written to one
+    if isfile(join(resdir, 'archive')):
+        fn = join(resdir, 'archive')
+        index, _ = _cachedindex(fn)
+        keys = sorted([k for k in index if (k[1] == varname) and (k[2] >= 0)], key=lambda k: k[2])
+        return(stack([readrecord(fn, index, *k) for k in keys]).T)
     #get potential file names
     fns = listdir(resdir)
     #filter for the ones with the variable name
@@ -0,0 +1,266 @@
+//! \file archive.cc
+
+#include <unistd.h>
+
+#include "archive.h"
+
+//------------------------------------------------------------------------------
+//packing and unpacking block contents
+
+static void pack (std::string &b, const void *x, size_t size) {
+    b.append((const char*)x, size);
+}
+
+static void pack_int32 (std::string &b, int32_t x) { pack(b, &x, sizeof(x)); }
+
+static void pack_int64 (std::string &b, int64_t x) { pack(b, &x, sizeof(x)); }
+
+static void pack_double (std::string &b, double x) { pack(b, &x, sizeof(x)); }
+
+static void pack_string (std::string &b, const std::string &s) {
+    pack_int32(b, int32_t(s.size()));
+    b.append(s);
+}
+
+//!packs the header fields shared by RECD blocks and INDX entries
+static void pack_header (std::string &b, const ArchiveRecord &r) {
+    pack_string(b, r.name);
+    pack_string(b, r.var);
+    pack_int64(b, r.isnap);
+    pack_double(b, r.t);
+    pack_int64(b, r.size);
+}
+
+static bool unpack (FILE *f, void *x, size_t size) {
+    return( fread(x, 1, size, f) == size );
+}
+
+static bool unpack_string (FILE *f, std::string &s) {
+    int32_t len;
+    if ( !unpack(f, &len, sizeof(len)) || (len < 0) ) return(false);
+    s.resize(len);
+    return( (len == 0) || unpack(f, &s[0], len) );
+}
+
+static bool unpack_header (FILE *f, ArchiveRecord &r) {
+    int64_t isnap, size;
+    if ( !unpack_string(f, r.name) ) return(false);
+    if ( !unpack_string(f, r.var) ) return(false);
+    if ( !unpack(f, &isnap, sizeof(isnap)) ) return(false);
+    if ( !unpack(f, &r.t, sizeof(r.t)) ) return(false);
+    if ( !unpack(f, &size, sizeof(size)) ) return(false);
+    r.isnap = long(isnap);
+    r.size = long(size);
+    return(true);
+}
+
+//!reads the records of an open archive, from its final index or by scanning its blocks
+/*!
+\param[in] f the archive, open for reading
+\param[out] records the records found
+\param[out] valid if given, the end of the last complete block, where a killed run's partial block starts
+*/
+static bool load_records (FILE *f, std::vector<ArchiveRecord> &records, int64_t *valid=NULL) {
+
+    char tag[8];
+    int64_t len, nrec, offset, end;
+    ArchiveRecord r;
+
+    records.clear();
+    //check the leading tag
+    fseek(f, 0, SEEK_SET);
+    if ( !unpack(f, tag, 8) || (memcmp(tag, "CRUSTAL1", 8) != 0) ) return(false);
+    fseek(f, 0, SEEK_END);
+    end = ftell(f);
+
+    //use the final index if the archive was closed
+    if ( end >= 8 + 16 ) {
+        fseek(f, end - 16, SEEK_SET);
+        if ( unpack(f, &offset, 8) && unpack(f, tag, 8) && (memcmp(tag, "CRUSTEND", 8) == 0) ) {
+            fseek(f, offset + 12, SEEK_SET);
+            if ( unpack(f, &nrec, 8) ) {
+                for (int64_t i=0; i<nrec; i++) {
+                    if ( !unpack(f, &offset, 8) || !unpack_header(f, r) ) break;
+                    r.offset = offset;
+                    records.push_back(r);
+                }
+                if ( int64_t(records.size()) == nrec ) {
+                    if ( valid ) *valid = end;
+                    return(true);
+                }
+            }
+            records.clear();
+        }
+    }
+
+    //otherwise scan the blocks, stopping at a truncated one
+    offset = 8;
+    while ( offset + 12 <= end ) {
+        fseek(f, offset, SEEK_SET);
+        if ( !unpack(f, tag, 4) || !unpack(f, &len, 8) ) break;
+        if ( offset + 12 + len > end ) break;
+        if ( memcmp(tag, "RECD", 4) == 0 ) {
+            if ( !unpack_header(f, r) ) break;
+            r.offset = offset;
+            records.push_back(r);
+        }
+        offset += 12 + len;
+    }
+    if ( valid ) *valid = offset;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+//writing
+
+Archive::Archive (const std::string &fn_, bool append) {
+
+    fn = fn_;
+    ofile = NULL;
+
+    //keep the records of an existing archive
+    if ( append ) {
+        FILE *f = fopen(fn.c_str(), "rb");
+        if ( f != NULL ) {
+            int64_t valid;
+            if ( !load_records(f, records, &valid) ) {
+                std::cout << "FAILURE: not an archive file " << fn << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            fclose(f);
+            //cut off a block left partly written by a killed run, so new
+            //blocks don't follow a length field that would run into them
+            if ( truncate(fn.c_str(), off_t(valid)) != 0 ) {
+                std::cout << "FAILURE: cannot truncate file " << fn << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            ofile = fopen(fn.c_str(), "ab");
+        }
+    }
+
+    //otherwise start a new file
+    if ( ofile == NULL ) {
+        records.clear();
+        ofile = fopen(fn.c_str(), "wb");
+        if ( ofile == NULL ) {
+            std::cout << "FAILURE: cannot open file " << fn << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        fwrite("CRUSTAL1", 1, 8, ofile);
+    }
+    fseek(ofile, 0, SEEK_END);
+    pos = ftell(ofile);
+}
+
+Archive::~Archive () {
+    close();
+}
+
+void Archive::append (const std::string &name, const std::string &var, long isnap, double t, const double *a, long size) {
+
+    ArchiveRecord r;
+    r.name = name;
+    r.var = var;
+    r.isnap = isnap;
+    r.t = t;
+    r.size = size;
+
+    //pack the block header outside the lock
+    std::string body, head;
+    pack_header(body, r);
+    head.append("RECD", 4);
+    pack_int64(head, int64_t(body.size() + size*sizeof(double)));
+    head.append(body);
+
+    std::lock_guard<std::mutex> guard(lock);
+    if ( ofile == NULL ) {
+        std::cout << "FAILURE: cannot append to closed archive " << fn << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    r.offset = pos;
+    fwrite(head.data(), 1, head.size(), ofile);
+    fwrite(a, sizeof(double), size, ofile);
+    pos += head.size() + size*sizeof(double);
+    records.push_back(r);
+}
+
+void Archive::append (const std::string &name, const std::string &var, const std::vector<double> &v) {
+    append(name, var, -1, NAN, v.data(), long(v.size()));
+}
+
+void Archive::flush () {
+    std::lock_guard<std::mutex> guard(lock);
+    if ( ofile != NULL ) fflush(ofile);
+}
+
+void Archive::close () {
+
+    std::lock_guard<std::mutex> guard(lock);
+    if ( ofile == NULL ) return;
+
+    //index of every record
+    std::string body, head;
+    pack_int64(body, int64_t(records.size()));
+    for (unsigned long i=0; i<records.size(); i++) {
+        pack_int64(body, records[i].offset);
+        pack_header(body, records[i]);
+    }
+    //trailer pointing to the index, inside the block so scans skip it
+    pack_int64(body, int64_t(pos));
+    body.append("CRUSTEND", 8);
+    head.append("INDX", 4);
+    pack_int64(head, int64_t(body.size()));
+    fwrite(head.data(), 1, head.size(), ofile);
+    fwrite(body.data(), 1, body.size(), ofile);
+
+    fclose(ofile);
+    ofile = NULL;
+}
+
+//------------------------------------------------------------------------------
+//reading
+
+ArchiveReader::ArchiveReader (const std::string &fn) {
+    ifile = fopen(fn.c_str(), "rb");
+    if ( ifile == NULL ) {
+        std::cout << "FAILURE: cannot open file " << fn << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if ( !load_records(ifile, records) ) {
+        std::cout << "FAILURE: not an archive file " << fn << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+ArchiveReader::~ArchiveReader () {
+    fclose(ifile);
+}
+
+long ArchiveReader::find (const std::string &name, const std::string &var, long isnap) {
+    //the latest record wins, as when a restarted run rewrites output
+    for (long i=long(records.size())-1; i>=0; i--)
+        if ( (records[i].isnap == isnap) && (records[i].name == name) && (records[i].var == var) )
+            return(i);
+    return(-1);
+}
+
+std::vector<double> ArchiveReader::read (const ArchiveRecord &r) {
+    std::vector<double> v(r.size);
+    //the values are at the end of the block
+    long long offset = r.offset + 12 + 4 + r.name.size() + 4 + r.var.size() + 24;
+    fseek(ifile, offset, SEEK_SET);
+    if ( fread(v.data(), sizeof(double), r.size, ifile) != (size_t)r.size ) {
+        std::cout << "FAILURE: truncated archive record " << r.name << " " << r.var << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return(v);
+}
+
+std::vector<double> ArchiveReader::read (const std::string &name, const std::string &var, long isnap) {
+    long i = find(name, var, isnap);
+    if ( i < 0 ) {
+        std::cout << "FAILURE: no archive record " << name << " " << var << " " << isnap << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return( read(records[i]) );
+}
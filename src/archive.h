@@ -0,0 +1,111 @@
+#ifndef ARCHIVE_H_
+#define ARCHIVE_H_
+
+//! \file archive.h
+
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+//!description of one record in an Archive
+struct ArchiveRecord {
+    //!name of the integration the record belongs to (the trial)
+    std::string name;
+    //!variable name
+    std::string var;
+    //!snap number, or -1 if the record isn't a snap
+    long isnap;
+    //!snap time, or NAN if the record isn't a snap
+    double t;
+    //!number of doubles in the record
+    long size;
+    //!byte offset of the record's block in the file
+    long long offset;
+};
+
+//!append-only file holding all the output of a run or a sweep
+/*!
+An archive file starts with the 8 byte tag "CRUSTAL1", followed by blocks. Every block starts with a 4 byte tag and an int64 count of the bytes after that count, so readers can skip blocks they don't need. All numbers are native (little endian) int32, int64, and double values.
+    - "RECD" blocks hold one record: int32 name length, name, int32 variable length, variable, int64 snap number, double snap time, int64 number of values, and the values as doubles.
+    - "INDX" blocks hold an index of every record before them: int64 number of records, then, for each record, its int64 block offset followed by the same header fields as its RECD block (without the values). The block ends with its own int64 offset and the 8 byte tag "CRUSTEND".
+
+Closing an archive appends an INDX block, so readers of a closed archive find the whole index at the end of the file and load it with one read. Archives that were never closed (a killed run) are still readable by scanning the blocks. Reopening an archive for appending keeps its records, and the next index covers all of them.
+
+A record may be appended more than once, as when a run is restarted, and readers use the latest one.
+
+Appends are serialized with a mutex, so one Archive can be shared by every thread of a sweep.
+*/
+class Archive {
+public:
+
+    //!opens an archive for writing
+    /*!
+    \param[in] fn path to the archive file
+    \param[in] append whether to keep the records of an existing archive, cutting off any block left partly written by a killed run
+    */
+    Archive (const std::string &fn, bool append=false);
+    //!closes the archive if it's still open
+    ~Archive ();
+
+    //!appends a record, safe to call from multiple threads
+    /*!
+    \param[in] name name of the integration the record belongs to
+    \param[in] var variable name
+    \param[in] isnap snap number, or -1 if the record isn't a snap
+    \param[in] t snap time, or NAN if the record isn't a snap
+    \param[in] a values to write
+    \param[in] size number of values
+    */
+    void append (const std::string &name, const std::string &var, long isnap, double t, const double *a, long size);
+    //!appends a record that isn't a snap, safe to call from multiple threads
+    void append (const std::string &name, const std::string &var, const std::vector<double> &v);
+    //!pushes appended records to the file, so they survive if the job is killed
+    void flush ();
+    //!writes the index and closes the file
+    void close ();
+
+private:
+
+    //!path to the file
+    std::string fn;
+    //!the open file, or NULL once closed
+    FILE *ofile;
+    //!current size of the file
+    long long pos;
+    //!every record in the file
+    std::vector<ArchiveRecord> records;
+    //!serializes appends
+    std::mutex lock;
+};
+
+//!reads the records of an Archive
+class ArchiveReader {
+public:
+
+    //!opens an archive and loads its index
+    ArchiveReader (const std::string &fn);
+    //!closes the file
+    ~ArchiveReader ();
+
+    //!every record in the archive, in the order written
+    std::vector<ArchiveRecord> records;
+
+    //!finds the latest record with a name, variable, and snap, returning its position in records or -1 if it's not there
+    long find (const std::string &name, const std::string &var, long isnap=-1);
+    //!reads the values of a record
+    std::vector<double> read (const ArchiveRecord &r);
+    //!reads the values of a record, or exits if it's not there
+    std::vector<double> read (const std::string &name, const std::string &var, long isnap=-1);
+
+private:
+
+    //!the open file
+    FILE *ifile;
+};
+
+#endif
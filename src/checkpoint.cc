@@ -0,0 +1,179 @@
+//! \file checkpoint.cc
+
+#include "checkpoint.h"
+
+//------------------------------------------------------------------------------
+//writing
+
+CheckpointWriter::CheckpointWriter (const std::string &fn_) {
+    fn = fn_;
+    fntmp = fn + ".tmp";
+    ofile = fopen(fntmp.c_str(), "wb");
+    if ( ofile == NULL ) {
+        std::cout << "FAILURE: cannot open file " << fntmp << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    fwrite("CRUSTCK1", 1, 8, ofile);
+}
+
+void CheckpointWriter::put (double x) {
+    fwrite(&x, sizeof(x), 1, ofile);
+}
+
+void CheckpointWriter::put (long x) {
+    int64_t y = x;
+    fwrite(&y, sizeof(y), 1, ofile);
+}
+
+void CheckpointWriter::put (const double *a, long size) {
+    put(size);
+    fwrite(a, sizeof(double), size, ofile);
+}
+
+void CheckpointWriter::put (const std::vector<double> &v) {
+    put(v.data(), long(v.size()));
+}
+
+void CheckpointWriter::put (const std::string &s) {
+    put(long(s.size()));
+    fwrite(s.data(), 1, s.size(), ofile);
+}
+
+void CheckpointWriter::close () {
+    if ( ofile == NULL ) return;
+    if ( fclose(ofile) != 0 ) {
+        std::cout << "FAILURE: cannot write checkpoint " << fntmp << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    ofile = NULL;
+    //replace the previous checkpoint in one step
+    if ( rename(fntmp.c_str(), fn.c_str()) != 0 ) {
+        std::cout << "FAILURE: cannot replace checkpoint " << fn << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+//------------------------------------------------------------------------------
+//reading
+
+CheckpointReader::CheckpointReader (const std::string &fn) {
+    char tag[8];
+    ifile = fopen(fn.c_str(), "rb");
+    good = (ifile != NULL) && (fread(tag, 1, 8, ifile) == 8) && (memcmp(tag, "CRUSTCK1", 8) == 0);
+}
+
+CheckpointReader::~CheckpointReader () {
+    if ( ifile != NULL ) fclose(ifile);
+}
+
+bool CheckpointReader::get (double &x) {
+    double y;
+    good = good && (fread(&y, sizeof(y), 1, ifile) == 1);
+    if ( good ) x = y;
+    return(good);
+}
+
+bool CheckpointReader::get (long &x) {
+    int64_t y;
+    good = good && (fread(&y, sizeof(y), 1, ifile) == 1);
+    if ( good ) x = long(y);
+    return(good);
+}
+
+bool CheckpointReader::get (double *a, long size) {
+    long len = -1;
+    good = good && get(len) && (len == size) && (fread(a, sizeof(double), size, ifile) == (size_t)size);
+    return(good);
+}
+
+bool CheckpointReader::get (std::vector<double> &v) {
+    long len = -1;
+    if ( !get(len) || (len < 0) ) return(good = false);
+    std::vector<double> u(len);
+    good = (fread(u.data(), sizeof(double), len, ifile) == (size_t)len);
+    if ( good ) v.swap(u);
+    return(good);
+}
+
+bool CheckpointReader::get (std::string &s) {
+    long len = -1;
+    if ( !get(len) || (len < 0) ) return(good = false);
+    std::string u(len, ' ');
+    good = (len == 0) || (fread(&u[0], 1, len, ifile) == (size_t)len);
+    if ( good ) s.swap(u);
+    return(good);
+}
+
+bool CheckpointReader::expect (long x) {
+    long y;
+    good = get(y) && (y == x);
+    return(good);
+}
+
+bool CheckpointReader::expect (double x) {
+    double y;
+    good = get(y) && (y == x);
+    return(good);
+}
+
+//------------------------------------------------------------------------------
+//sweep manifest
+
+Manifest::Manifest (const std::string &fn) {
+    //trials finished by earlier runs
+    bool cut = false;
+    FILE *ifile = fopen(fn.c_str(), "r");
+    if ( ifile != NULL ) {
+        char line[4096], *c;
+        //skip a last line cut off by a killed job
+        while ( fgets(line, sizeof(line), ifile) != NULL ) {
+            cut = strchr(line, '\n') == NULL;
+            if ( cut ) continue;
+            long long i = atoll(line);
+            done.insert(i);
+            //reductions following the trial number
+            std::vector<double> row;
+            for (c=strchr(line, ','); c!=NULL; c=strchr(c+1, ','))
+                row.push_back( strtod(c+1, NULL) );
+            if ( !row.empty() ) rows[i] = row;
+        }
+        fclose(ifile);
+    }
+    ofile = fopen(fn.c_str(), "a");
+    if ( ofile == NULL ) {
+        std::cout << "FAILURE: cannot open file " << fn << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    //finish a cut off line so it isn't joined to the next trial
+    if ( cut ) fprintf(ofile, "\n");
+}
+
+Manifest::~Manifest () {
+    fclose(ofile);
+}
+
+bool Manifest::finished (long long i) {
+    std::lock_guard<std::mutex> guard(lock);
+    return( done.count(i) > 0 );
+}
+
+void Manifest::finish (long long i, const std::vector<double> &row) {
+    std::lock_guard<std::mutex> guard(lock);
+    done.insert(i);
+    if ( !row.empty() ) rows[i] = row;
+    fprintf(ofile, "%lli", i);
+    for (unsigned long j=0; j<row.size(); j++) fprintf(ofile, ",%.17g", row[j]);
+    fprintf(ofile, "\n");
+    fflush(ofile);
+}
+
+std::vector<double> Manifest::row (long long i) {
+    std::lock_guard<std::mutex> guard(lock);
+    std::map< long long, std::vector<double> >::iterator it = rows.find(i);
+    return( it == rows.end() ? std::vector<double>() : it->second );
+}
+
+long long Manifest::get_nfinished () {
+    std::lock_guard<std::mutex> guard(lock);
+    return( (long long)done.size() );
+}
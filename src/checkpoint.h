@@ -0,0 +1,98 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+//! \file checkpoint.h
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+//!writes the state of an integration to a checkpoint file
+/*!
+The file is written under a temporary name and renamed over any previous checkpoint when closed, so a job killed while writing leaves the previous checkpoint intact. Values are written in native binary form after the 8 byte tag "CRUSTCK1", in whatever order the writing class chooses, and must be read back in the same order.
+*/
+class CheckpointWriter {
+public:
+    //!opens a temporary file next to fn
+    CheckpointWriter (const std::string &fn);
+    //!writes a double
+    void put (double x);
+    //!writes an integer
+    void put (long x);
+    //!writes an array of doubles, preceded by its length
+    void put (const double *a, long size);
+    //!writes a vector of doubles, preceded by its length
+    void put (const std::vector<double> &v);
+    //!writes a string, preceded by its length
+    void put (const std::string &s);
+    //!closes the temporary file and renames it to fn
+    void close ();
+private:
+    std::string fn, fntmp;
+    FILE *ofile;
+};
+
+//!reads a checkpoint file written by CheckpointWriter
+/*!
+Every get returns false, and leaves its argument alone, if the file is missing, truncated, or doesn't hold what's expected, so the reading class can fall back to starting over.
+*/
+class CheckpointReader {
+public:
+    //!opens fn, if it exists and starts with the checkpoint tag
+    CheckpointReader (const std::string &fn);
+    //!closes the file
+    ~CheckpointReader ();
+    //!whether the file is open and nothing has failed to read
+    bool ok () const { return(good); }
+    //!reads a double
+    bool get (double &x);
+    //!reads an integer
+    bool get (long &x);
+    //!reads an array of doubles, which must have the given length
+    bool get (double *a, long size);
+    //!reads a vector of doubles of any length
+    bool get (std::vector<double> &v);
+    //!reads a string
+    bool get (std::string &s);
+    //!reads an integer and checks that it matches an expected value
+    bool expect (long x);
+    //!reads a double and checks that it matches an expected value
+    bool expect (double x);
+private:
+    FILE *ifile;
+    bool good;
+};
+
+//!record of the finished trials of a sweep, so a restarted sweep skips them
+/*!
+The manifest is a text file with one finished trial number per line, followed by the trial's reductions if the sweep has any, comma separated, appended and flushed as trials finish, so it survives a killed job. Trials not in the manifest are run again when a sweep is restarted, resuming from their checkpoints if they have them.
+*/
+class Manifest {
+public:
+    //!reads the trials already in the manifest file, if it exists, and opens it for appending
+    Manifest (const std::string &fn);
+    //!closes the file
+    ~Manifest ();
+    //!whether a trial is finished
+    bool finished (long long i);
+    //!records a finished trial, with its reductions, safe to call from multiple threads
+    void finish (long long i, const std::vector<double> &row=std::vector<double>());
+    //!reductions recorded with a finished trial, empty if there weren't any
+    std::vector<double> row (long long i);
+    //!number of finished trials
+    long long get_nfinished ();
+private:
+    FILE *ofile;
+    std::set<long long> done;
+    std::map< long long, std::vector<double> > rows;
+    std::mutex lock;
+};
+
+#endif
@@ -0,0 +1,156 @@
+//! \file diagnostics.cc
+
+#include "diagnostics.h"
+
+Diagnostics::Diagnostics () :
+    ziso  (2, tracker_last),
+    zthaw (2, tracker_max),
+    E     (2, tracker_last),
+    Qst   (2, tracker_last) {
+
+    active_ = false;
+    n = 0;
+    dep = 0.0;
+    tlast = NAN;
+    qlast = NAN;
+    Qs = 0.0;
+}
+
+void Diagnostics::reset (const Grid &grid, const Settings &stgin, const double *c, const double *rho) {
+
+    stg = stgin;
+    n = long(grid.get_n());
+    dep = grid.get_dep();
+    zc = grid.get_zc();
+    delz = grid.get_delz();
+    crdz.resize(n);
+    for (long i=0; i<n; i++) crdz[i] = c[i]*rho[i]*delz[i];
+
+    //probes from the settings
+    zprobe.clear();
+    ia.clear();
+    ib.clear();
+    wa.clear();
+    Tprobe.clear();
+    for (long j=0; j<stg.nprobe; j++)
+        add_probe( stg.nprobe > 1 ? stg.probe0 + (stg.probe1 - stg.probe0)*double(j)/double(stg.nprobe - 1) : stg.probe0 );
+
+    ziso.reset(stg.nmaxout);
+    zthaw.reset(stg.nmaxout);
+    E.reset(stg.nmaxout);
+    Qst.reset(stg.nmaxout);
+    active_ = (stg.nprobe > 0) || stg.ziso || stg.zthaw || stg.E || stg.Qs;
+    tlast = NAN;
+    qlast = NAN;
+    Qs = 0.0;
+}
+
+void Diagnostics::add_probe (double depth) {
+    //bracketing cells, as interp finds them, clamped to the end cells
+    double z = -depth;
+    long i = 0;
+    while ( (i < n-1) && (z > zc[i+1]) ) i++;
+    zprobe.push_back(depth);
+    ia.push_back(i);
+    if ( (z <= zc[0]) || (i == n-1) ) {
+        ib.push_back(i);
+        wa.push_back(0.0);
+    } else {
+        ib.push_back(i+1);
+        wa.push_back( (z - zc[i])/(zc[i+1] - zc[i]) );
+    }
+    Tprobe.push_back( Tracker(stg.nmaxout, tracker_last) );
+    active_ = true;
+}
+
+//------------------------------------------------------------------------------
+
+double Diagnostics::isotherm (const double *T, long stride, double Ts) const {
+    //from the surface down, through the cell centers
+    double za = 0.0, ga = Ts - stg.Tiso, zb, gb;
+    if ( ga == 0 ) return(za);
+    for (long i=n-1; i>=0; i--) {
+        zb = -zc[i];
+        gb = T[i*stride] - stg.Tiso;
+        if ( (gb == 0) || ((ga < 0) != (gb < 0)) )
+            return( za + (zb - za)*ga/(ga - gb) );
+        za = zb;
+        ga = gb;
+    }
+    return(NAN);
+}
+
+double Diagnostics::energy (const double *T, long stride) const {
+    double H = 0.0, Ti;
+    for (long i=0; i<n; i++) {
+        Ti = T[i*stride];
+        H += crdz[i]*(Ti - stg.Tf) + (Ti > stg.Tf ? stg.LH*delz[i] : 0.0);
+    }
+    return(H);
+}
+
+void Diagnostics::start (double tin, double qs) {
+    tlast = tin;
+    qlast = qs;
+    Qs = 0.0;
+}
+
+void Diagnostics::update (double tin, const double *T, long stride, double Ts, double qs) {
+
+    //trapezoidal surface heat loss over the step
+    Qs += (tin - tlast)*(qlast + qs)/2.0;
+    tlast = tin;
+    qlast = qs;
+
+    for (unsigned long j=0; j<Tprobe.size(); j++)
+        Tprobe[j].push( probe(j, T, stride) );
+    if ( stg.ziso || stg.zthaw ) {
+        double z = isotherm(T, stride, Ts);
+        if ( stg.ziso )
+            ziso.push( z );
+        //the whole column is thawed if the surface is warm and there's no isotherm
+        if ( stg.zthaw )
+            zthaw.push( Ts > stg.Tiso ? (std::isnan(z) ? dep : z) : 0.0 );
+    }
+    if ( stg.E )
+        E.push( energy(T, stride) );
+    if ( stg.Qs )
+        Qst.push( Qs );
+}
+
+//------------------------------------------------------------------------------
+
+void Diagnostics::write (std::function<void(const std::string&, const std::vector<double>&)> out) const {
+    if ( !Tprobe.empty() ) {
+        out("zprobe", zprobe);
+        for (unsigned long j=0; j<Tprobe.size(); j++)
+            out("probe" + int_to_string(long(j)), Tprobe[j].values());
+    }
+    if ( stg.ziso )
+        out("ziso", ziso.values());
+    if ( stg.zthaw )
+        out("zthaw", zthaw.values());
+    if ( stg.E )
+        out("E", E.values());
+    if ( stg.Qs )
+        out("Qs", Qst.values());
+}
+
+void Diagnostics::save (CheckpointWriter &ck) const {
+    ck.put(long(Tprobe.size()));
+    ck.put(tlast);
+    ck.put(qlast);
+    ck.put(Qs);
+    for (unsigned long j=0; j<Tprobe.size(); j++) Tprobe[j].save(ck);
+    ziso.save(ck);
+    zthaw.save(ck);
+    E.save(ck);
+    Qst.save(ck);
+}
+
+bool Diagnostics::load (CheckpointReader &ck) {
+    if ( !ck.expect(long(Tprobe.size())) || !ck.get(tlast) || !ck.get(qlast) || !ck.get(Qs) ) return(false);
+    for (unsigned long j=0; j<Tprobe.size(); j++)
+        if ( !Tprobe[j].load(ck) ) return(false);
+    return( ziso.load(ck) && zthaw.load(ck) && E.load(ck) && Qst.load(ck) );
+}
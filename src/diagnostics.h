@@ -0,0 +1,127 @@
+#ifndef DIAGNOSTICS_H_
+#define DIAGNOSTICS_H_
+
+//! \file diagnostics.h
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "io.h"
+#include "grid.h"
+#include "tracker.h"
+#include "settings.h"
+#include "checkpoint.h"
+
+//!quantities derived from the temperature profile after every step, kept in trackers instead of profile snaps
+/*!
+The diagnostics are switched on by settings (see Settings) and each is stored in a Tracker of at most nmaxout values, so they take fixed memory however long the integration is:
+    - temperatures at probe depths, nprobe of them evenly spaced from probe0 to probe1, and any added with add_probe, written as probe0, probe1, ..., with their depths in zprobe
+    - the depth of the shallowest Tiso isotherm, searching down from the surface (ziso), or NAN if there isn't one
+    - the thaw depth, the bottom of the surface layer warmer than Tiso, as the largest in each bucket, which is the active layer thickness once buckets span a year of forcing (zthaw)
+    - the heat content of the column per unit area, the enthalpy of Heat::f_H summed over the cells (E)
+    - the heat lost through the surface per unit area since the start, integrating the surface flux with the trapezoid rule over steps (Qs)
+
+Probes are interpolated linearly between cell centers, like Heat::probe, with the bracketing cells and weights found when they're added, so each costs a few operations per step. The isotherm search starts at the surface and stops at the first crossing, so it only goes as deep as the front. Only the heat content passes over every cell. Profiles are given with a stride between cells, so HeatBatch lanes can be read in place.
+*/
+class Diagnostics {
+public:
+
+    //!constructs, with every diagnostic off
+    Diagnostics ();
+
+    //!sets up the diagnostics of a settings on a grid, removing probes and clearing the trackers
+    /*!
+    \param[in] grid the grid of the profiles
+    \param[in] stg settings choosing the diagnostics
+    \param[in] c specific heat of each cell (J/kg*K)
+    \param[in] rho density of each cell (kg/m^3)
+    */
+    void reset (const Grid &grid, const Settings &stg, const double *c, const double *rho);
+    //!adds a temperature probe
+    /*!
+    \param[in] depth probe depth (m)
+    */
+    void add_probe (double depth);
+    //!whether any diagnostic is on, so that profiles need to be given to update
+    bool active () const { return( active_ ); }
+
+    //!begins an integration, tracking nothing but setting the start of the surface heat loss integral
+    /*!
+    \param[in] tin starting time
+    \param[in] qs surface heat flux (W/m^2)
+    */
+    void start (double tin, double qs);
+    //!tracks the diagnostics of a profile at the end of a step
+    /*!
+    \param[in] tin time at the end of the step
+    \param[in] T temperatures, T[i*stride] in cell i (K)
+    \param[in] stride distance between cells in T
+    \param[in] Ts surface temperature (K)
+    \param[in] qs surface heat flux (W/m^2)
+    */
+    void update (double tin, const double *T, long stride, double Ts, double qs);
+
+    //!temperature at a probe, given a profile (K)
+    double probe (long j, const double *T, long stride) const { return( T[ia[j]*stride] + wa[j]*(T[ib[j]*stride] - T[ia[j]*stride]) ); }
+    //!depth of the shallowest Tiso isotherm of a profile, or NAN if there isn't one (m)
+    double isotherm (const double *T, long stride, double Ts) const;
+    //!heat content of a profile per unit area (J/m^2)
+    double energy (const double *T, long stride) const;
+    //!heat lost through the surface since the start (J/m^2)
+    double get_Qs () const { return(Qs); }
+
+    //!passes the name and values of every diagnostic that's on to a function, for writing
+    void write (std::function<void(const std::string&, const std::vector<double>&)> out) const;
+    //!writes the diagnostics' state to a checkpoint
+    void save (CheckpointWriter &ck) const;
+    //!restores the diagnostics' state from a checkpoint, returning false if it doesn't match
+    bool load (CheckpointReader &ck);
+
+private:
+
+    //!whether anything is tracked
+    bool active_;
+    //!settings choosing the diagnostics
+    Settings stg;
+    //!number of cells
+    long n;
+    //!depth of the domain (m)
+    double dep;
+    //!cell center coordinates (m)
+    GridView zc;
+    //!cell widths (m)
+    GridView delz;
+    //!heat capacity of each cell per unit area, c*rho*delz (J/m^2*K)
+    std::vector<double> crdz;
+
+    //!probe depths (m)
+    std::vector<double> zprobe;
+    //!deeper bracketing cell of each probe
+    std::vector<long> ia;
+    //!shallower bracketing cell of each probe
+    std::vector<long> ib;
+    //!interpolation weight of the shallower cell of each probe
+    std::vector<double> wa;
+
+    //!time of the last update
+    double tlast;
+    //!surface flux at the last update (W/m^2)
+    double qlast;
+    //!surface heat loss since the start (J/m^2)
+    double Qs;
+
+    //!probe trackers
+    std::vector<Tracker> Tprobe;
+    //!isotherm depth tracker
+    Tracker ziso;
+    //!thaw depth tracker, the largest in each bucket
+    Tracker zthaw;
+    //!heat content tracker
+    Tracker E;
+    //!surface heat loss tracker
+    Tracker Qst;
+};
+
+#endif
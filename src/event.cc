@@ -0,0 +1,57 @@
+//! \file event.cc
+
+#include "event.h"
+
+Event::Event (EventKind kind_, double value_, int direction_, bool terminal_, double depth_) {
+    kind = kind_;
+    value = value_;
+    direction = direction_;
+    terminal = terminal_;
+    depth = depth_;
+    tcross = NAN;
+    tlast = NAN;
+    glast = NAN;
+}
+
+void Event::start (double t, double x) {
+    tcross = NAN;
+    tlast = t;
+    glast = x - value;
+}
+
+bool Event::check (double t, double x) {
+
+    double g = x - value;
+    bool crossed = false;
+
+    //only the first crossing is located
+    if ( !found() && !std::isnan(glast) ) {
+        if ( (direction >= 0) && (glast < 0.0) && (g >= 0.0) ) crossed = true;
+        if ( (direction <= 0) && (glast > 0.0) && (g <= 0.0) ) crossed = true;
+        //interpolate to the crossing time
+        if ( crossed )
+            tcross = tlast + (t - tlast)*glast/(glast - g);
+    }
+    tlast = t;
+    glast = g;
+
+    return(crossed);
+}
+
+void Event::save (CheckpointWriter &ck) const {
+    ck.put(long(kind));
+    ck.put(value);
+    ck.put(tcross);
+    ck.put(tlast);
+    ck.put(glast);
+}
+
+bool Event::load (CheckpointReader &ck) {
+    double tcross_, tlast_, glast_;
+    if ( !ck.expect(long(kind)) || !ck.expect(value) ) return(false);
+    if ( !ck.get(tcross_) || !ck.get(tlast_) || !ck.get(glast_) ) return(false);
+    tcross = tcross_;
+    tlast = tlast_;
+    glast = glast_;
+    return(true);
+}
@@ -0,0 +1,71 @@
+#ifndef EVENT_H_
+#define EVENT_H_
+
+//! \file event.h
+
+#include <cmath>
+
+#include "checkpoint.h"
+
+//!quantity monitored by an Event
+enum EventKind {
+    //!minimum temperature in the column
+    event_Tmin,
+    //!maximum temperature in the column
+    event_Tmax,
+    //!temperature at a fixed depth, interpolated between cell centers
+    event_probe,
+    //!heat flux through the surface
+    event_qs
+};
+
+//!a threshold crossing located during an integration
+/*!
+The monitored quantity is checked at the end of every step and the first crossing of the threshold is located inside the step by linear interpolation, which is the dense output consistent with the second order solvers used here. A terminal event stops the integration at the end of the step it's found in.
+*/
+class Event {
+public:
+
+    //!constructs
+    /*!
+    \param[in] kind monitored quantity
+    \param[in] value threshold that the quantity crosses
+    \param[in] direction 1 for rising crossings only, -1 for falling crossings only, 0 for either
+    \param[in] terminal whether to stop the integration when the event is found
+    \param[in] depth depth of the temperature probe for event_probe (m)
+    */
+    Event (EventKind kind, double value, int direction=0, bool terminal=false, double depth=0.0);
+
+    //!monitored quantity
+    EventKind kind;
+    //!threshold
+    double value;
+    //!direction of crossings to detect
+    int direction;
+    //!whether to stop the integration when found
+    bool terminal;
+    //!probe depth for event_probe (m)
+    double depth;
+    //!time of the first crossing, NAN until found
+    double tcross;
+
+    //!begins monitoring, given the quantity at the starting time
+    void start (double t, double x);
+    //!checks the quantity at the end of a step, returning true if it crossed during the step
+    bool check (double t, double x);
+    //!whether the crossing has been found
+    bool found () const { return( !std::isnan(tcross) ); }
+    //!writes the event's state to a checkpoint
+    void save (CheckpointWriter &ck) const;
+    //!restores the event's state from a checkpoint, returning false if it was saved from a different event
+    bool load (CheckpointReader &ck);
+
+private:
+
+    //!time of the previous check
+    double tlast;
+    //!quantity minus threshold at the previous check
+    double glast;
+};
+
+#endif
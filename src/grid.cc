@@ -2,9 +2,27 @@
 
 #include "grid.h"
 
+//!number of doubles in a cache line
+#define GRID_ALIGN 8
+
+//!copies an array into the grid block, padded to a whole number of cache lines
+static long pack_array (const std::vector<double> &a, std::vector<double> &block, long &offset) {
+    long start = offset;
+    for (unsigned long i=0; i<a.size(); i++) block[offset+i] = a[i];
+    offset += ((long(a.size()) + GRID_ALIGN - 1)/GRID_ALIGN)*GRID_ALIGN;
+    return(start);
+}
+
 Grid::Grid (double depth, double delz0, double delzfrac, double delzmax) {
 
     long i;
+    std::vector<double> ze, zc, delz, delze, vefac, gefac;
+
+    //store the arguments, for comparing with other grids
+    args[0] = depth;
+    args[1] = delz0;
+    args[2] = delzfrac;
+    args[3] = delzmax;
 
     //compute grid edges
     grid_edges(depth, delz0, delzfrac, delzmax, ze);
@@ -36,15 +54,48 @@ Grid::Grid (double depth, double delz0, double delzfrac, double delzmax) {
     for (i=1; i<n; i++) gefac.push_back( 1.0/(zc[i] - zc[i-1]) );
     gefac.push_back( NAN );
 
+    //pack everything into one block, with each array starting on a cache line
+    long len = 6*(((n + 1) + GRID_ALIGN - 1)/GRID_ALIGN)*GRID_ALIGN;
+    std::shared_ptr< std::vector<double> > b = std::make_shared< std::vector<double> >(len + GRID_ALIGN);
+    long offset = long( (64 - (reinterpret_cast<uintptr_t>(b->data()) % 64)) % 64 )/long(sizeof(double));
+    long ize    = pack_array(ze, *b, offset);
+    long izc    = pack_array(zc, *b, offset);
+    long idelz  = pack_array(delz, *b, offset);
+    long idelze = pack_array(delze, *b, offset);
+    long ivefac = pack_array(vefac, *b, offset);
+    long igefac = pack_array(gefac, *b, offset);
+    block = b;
+
+    //views into the block
+    const double *p = block->data();
+    this->ze    = GridView(p + ize, n + 1);
+    this->zc    = GridView(p + izc, n);
+    this->delz  = GridView(p + idelz, n);
+    this->delze = GridView(p + idelze, n + 1);
+    this->vefac = GridView(p + ivefac, n + 1);
+    this->gefac = GridView(p + igefac, n + 1);
+}
+
+bool Grid::matches (double depth, double delz0, double delzfrac, double delzmax) const {
+    return( (args[0] == depth) && (args[1] == delz0) && (args[2] == delzfrac) && (args[3] == delzmax) );
+}
+
+void Grid::save (std::string dirout) const {
+    write_double(dirout + "/zc", zc.data(), zc.size());
+    write_double(dirout + "/ze", ze.data(), ze.size());
+    write_double(dirout + "/delz", delz.data(), delz.size());
+    write_double(dirout + "/delze", delze.data(), delze.size());
+    write_double(dirout + "/vefac", vefac.data(), vefac.size());
+    write_double(dirout + "/gefac", gefac.data(), gefac.size());
 }
 
-void Grid::save (std::string dirout) {
-    write_double(dirout + "/zc", zc);
-    write_double(dirout + "/ze", ze);
-    write_double(dirout + "/delz", delz);
-    write_double(dirout + "/delze", delze);
-    write_double(dirout + "/vefac", vefac);
-    write_double(dirout + "/gefac", gefac);
+void Grid::save (Archive &archive) const {
+    archive.append("grid", "zc", -1, NAN, zc.data(), zc.size());
+    archive.append("grid", "ze", -1, NAN, ze.data(), ze.size());
+    archive.append("grid", "delz", -1, NAN, delz.data(), delz.size());
+    archive.append("grid", "delze", -1, NAN, delze.data(), delze.size());
+    archive.append("grid", "vefac", -1, NAN, vefac.data(), vefac.size());
+    archive.append("grid", "gefac", -1, NAN, gefac.data(), gefac.size());
 }
 
 void Grid::grid_edges(double depth, double delz0, double delzfrac,
@@ -7,10 +7,40 @@
 #include <string>
 #include <vector>
 #include <cstdio>
+#include <memory>
+#include <cstdint>
 
 #include "io.h"
+#include "archive.h"
+
+//!read-only view of an array of doubles owned by a Grid, which doesn't copy the array
+class GridView {
+public:
+    //!constructs an empty view
+    GridView () : ptr (NULL), len (0) {}
+    //!constructs a view of len values starting at ptr
+    GridView (const double *ptr, long len) : ptr (ptr), len (len) {}
+    //!gets a value
+    const double &operator[] (long i) const { return(ptr[i]); }
+    //!gets a pointer to the first value
+    const double *data () const { return(ptr); }
+    //!gets the number of values
+    long size () const { return(len); }
+    //!start of the values, for range loops
+    const double *begin () const { return(ptr); }
+    //!end of the values, for range loops
+    const double *end () const { return(ptr + len); }
+    //!copies the values into a vector
+    operator std::vector<double> () const { return(std::vector<double>(ptr, ptr + len)); }
+private:
+    const double *ptr;
+    long len;
+};
 
 //!class setting up and containing finite-volume grid information
+/*!
+The grid arrays are computed once by the constructor and never modified. They're stored in a single block of memory, each starting on a cache line, which is shared by every copy of the Grid. Copying a Grid, or constructing integrators from one, only copies a reference to the block, and the accessors return views into it, so any number of trials in a sweep can share one grid without copying it.
+*/
 class Grid {
 public:
 
@@ -24,24 +54,29 @@ public:
     Grid (double depth, double delz0, double delzfrac, double delzmax);
 
     //!gets number of cells
-    double get_n () { return(n); }
+    double get_n () const { return(n); }
     //!gets length/depth of the domain (m)
-    double get_dep () { return(dep); }
-    //!gets vector of cell edge coordinates (m)
-    const std::vector<double> get_ze () const { return(ze); }
-    //!gets vector of cell center coordinates (m)
-    const std::vector<double> get_zc () const { return(zc); }
-    //!gets vector of z cell width (m)
-    const std::vector<double> get_delz () const { return(delz); }
-    //!gets vector of z cell widths used for stability calculations (m)
-    const std::vector<double> get_delze () const { return(delze); }
-    //!gets vector of factors for cell edge values
-    const std::vector<double> get_vefac () const { return(vefac); }
-    //!gets vector of factors for cell edge gradients
-    const std::vector<double> get_gefac () const { return(gefac); }
+    double get_dep () const { return(dep); }
+    //!gets view of cell edge coordinates (m)
+    GridView get_ze () const { return(ze); }
+    //!gets view of cell center coordinates (m)
+    GridView get_zc () const { return(zc); }
+    //!gets view of z cell width (m)
+    GridView get_delz () const { return(delz); }
+    //!gets view of z cell widths used for stability calculations (m)
+    GridView get_delze () const { return(delze); }
+    //!gets view of factors for cell edge values
+    GridView get_vefac () const { return(vefac); }
+    //!gets view of factors for cell edge gradients
+    GridView get_gefac () const { return(gefac); }
+
+    //!whether the grid was constructed with the same arguments, and so has the same arrays
+    bool matches (double depth, double delz0, double delzfrac, double delzmax) const;
 
     //!writes grid arrays into a directory as binary files
-    void save (std::string dirout);
+    void save (std::string dirout) const;
+    //!writes grid arrays into an archive, under the name "grid"
+    void save (Archive &archive) const;
 
 private:
 
@@ -49,18 +84,22 @@ private:
     long n;
     //!length of the domain (m)
     double dep;
+    //!constructor arguments: depth, delz0, delzfrac, delzmax
+    double args[4];
+    //!shared block holding every grid array
+    std::shared_ptr<const std::vector<double> > block;
     //!cell edge coordinates (m)
-    std::vector<double> ze;
+    GridView ze;
     //!cell center coordinates (m)
-    std::vector<double> zc;
+    GridView zc;
     //!cell width (m)
-    std::vector<double> delz;
+    GridView delz;
     //!cell widths used for stability calculations (m)
-    std::vector<double> delze;
+    GridView delze;
     //!factors for cell edge values
-    std::vector<double> vefac;
+    GridView vefac;
     //!factors for cell edge gradients
-    std::vector<double> gefac;
+    GridView gefac;
 
     void grid_edges(double depth, double delz0, double delzfrac,
                     double delzmax, std::vector<double> &ze);
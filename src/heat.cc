@@ -2,9 +2,9 @@
 
 #include "heat.h"
 
-Heat::Heat (Grid grid, Settings stgin) :
-    OdeTrapz (grid.get_n()),
-    stg (copy_settings(stgin)),
+Heat::Heat (const Grid &gridin, Settings stgin) :
+    OdeTrapz (gridin.get_n()),
+    grid  (gridin),
     n     (grid.get_n()),
     dep   (grid.get_dep()),
     ze    (grid.get_ze()),
@@ -12,25 +12,28 @@ Heat::Heat (Grid grid, Settings stgin) :
     delz  (grid.get_delz()),
     delze (grid.get_delze()),
     vefac (grid.get_vefac()),
-    gefac (grid.get_gefac()) {
+    gefac (grid.get_gefac()),
+    t     (stgin.nmaxout, tracker_last),
+    Tmax  (stgin.nmaxout, tracker_max),
+    Tmin  (stgin.nmaxout, tracker_min),
+    Ts    (stgin.nmaxout, tracker_last),
+    qs    (stgin.nmaxout, tracker_last),
+    dts   (stgin.nmaxout, tracker_min) {
 
-    long i;
+    TELEMETRY_TIME(tel.tconstruct);
 
     //set the name of the object
     this->set_name("heat");
     //turn on silent snapping
     this->set_silent_snap(true);
+    //output goes to separate files until an archive is set
+    archive = NULL;
+    writer = NULL;
 
-    //------------------
     //physical variables
-
-    //density of medium
-    for (i=0; i<n; i++) rho.push_back( f_rho(stg.rho0, -zc[i]) );
-    //thermal conductivity of medium
-    for (i=0; i<n+1; i++) k.push_back( f_k(stg.k0, -ze[i]) );
-    //specific heat
-    for (i=0; i<n; i++) c.push_back( f_c(stg.c0, -zc[i]) );
-
+    rho.resize(n);
+    k.resize(n+1);
+    c.resize(n);
     //thermal capacity
     cap.resize(n);
     //derivative of moisture w/r/t z
@@ -38,6 +41,77 @@ Heat::Heat (Grid grid, Settings stgin) :
     //fluxes
     q.resize(n+1);
 
+    //implicit solver work arrays
+    Tprev.resize(n);
+    tdl.resize(n);
+    tdd.resize(n);
+    tdu.resize(n);
+    tdr.resize(n);
+    //explicit solver work arrays
+    f1.resize(n);
+    f2.resize(n);
+    Tstg.resize(n);
+    Tstg2.resize(n);
+    //multirate time step levels
+    level.resize(n);
+
+    init(stgin);
+}
+
+void Heat::reset (Settings stgin) {
+
+    tel = Telemetry();
+    TELEMETRY_TIME(tel.tconstruct);
+
+    init(stgin);
+}
+
+void Heat::init (Settings &stgin) {
+
+    long i;
+
+    stg = copy_settings(stgin);
+
+    //------------------
+    //physical variables
+
+    //density of medium
+    for (i=0; i<n; i++) rho[i] = Heat::f_rho(stg.rho0, -zc[i]);
+    //thermal conductivity of medium
+    for (i=0; i<n+1; i++) k[i] = Heat::f_k(stg.k0, -ze[i]);
+    //specific heat
+    for (i=0; i<n; i++) c[i] = Heat::f_c(stg.c0, -zc[i]);
+
+    //--------------------------------
+    //trackers, events, and solver state
+
+    t.reset(stg.nmaxout);
+    Tmax.reset(stg.nmaxout);
+    Tmin.reset(stg.nmaxout);
+    Ts.reset(stg.nmaxout);
+    qs.reset(stg.nmaxout);
+    dts.reset(stg.nmaxout);
+    tsnap.clear();
+    events.clear();
+    reducers.clear();
+    diag.reset(grid, stg, c.data(), rho.data());
+    //no enthalpies until an enthalpy solve starts
+    H.clear();
+    nstage = 0;
+    //no steps taken yet
+    hstep = NAN;
+    this->set_t(0);
+    nstep = 0;
+    neval = 0;
+    //no events found yet
+    halt = false;
+    //radiative surface solves start from the surface cell
+    Tsrad = NAN;
+    //no periodic solve yet
+    nshoot = 0;
+    nperiod = 0;
+    pres = NAN;
+
     //-----------------------------------
     //initial temperatures and capacities
 
@@ -45,23 +119,22 @@ Heat::Heat (Grid grid, Settings stgin) :
         //temperature
         set_sol(i,
             f_geotherm(
-                f_Ts(0, stg.Tsa, stg.Tsb, stg.Tsc),
-                f_qgeo(stg.qgeo0, 0),
-                f_k(stg.k0, 0),
+                Heat::f_Ts(0, stg.Tsa, stg.Tsb, stg.Tsc),
+                Heat::f_qgeo(stg.qgeo0, 0),
+                Heat::f_k(stg.k0, 0),
                 -zc[i]
             )
         );
         //thermal capacity
-        cap[i] = f_cap(c[i], rho[i], get_sol(i));
+        cap[i] = Heat::f_cap(c[i], rho[i], get_sol(i));
     }
 
     //---------------
     //maximum stable time step
 
-    double dt, tem;
-    dtmax = INFINITY;
-    for (long i=0; i<n+1; i++) {
-        //get the appropriate (maximum) capacity
+    //stable time step at each edge, using the larger capacity of its cells
+    auto dtedge = [this](long i) {
+        double tem;
         if ( i == 0 ) {
             tem = c[0]*rho[0];
         } else if ( i == n ) {
@@ -69,11 +142,55 @@ Heat::Heat (Grid grid, Settings stgin) :
         } else {
             tem = c[i]*rho[i] > c[i-1]*rho[i-1] ? c[i]*rho[i] : c[i-1]*rho[i-1];
         }
-        //compute stable time step
-        dt = delze[i]*delze[i]/(2.0*k[i]/tem);
+        return( delze[i]*delze[i]/(2.0*k[i]/tem) );
+    };
+    double dt;
+    dtmax = INFINITY;
+    for (i=0; i<n+1; i++) {
+        dt = dtedge(i);
         if ( dtmax > dt )
             dtmax = dt;
     }
+
+    //---------------
+    //multirate time step levels
+
+    if ( stg.nlevel < 1 )
+        print_exit("the nlevel setting must be at least 1");
+    //each cell steps at the largest power of two times dtmax that is stable at both of its edges
+    double dtb, dtt;
+    for (i=0; i<n; i++) {
+        dtb = dtedge(i);
+        dtt = dtedge(i+1);
+        dt = dtb < dtt ? dtb : dtt;
+        level[i] = long(floor(log2(dt/dtmax)));
+        if ( level[i] < 0 ) level[i] = 0;
+        if ( level[i] > stg.nlevel - 1 ) level[i] = stg.nlevel - 1;
+    }
+    //neighboring cells differ by at most one level
+    for (i=1; i<n; i++)
+        if ( level[i] > level[i-1] + 1 ) level[i] = level[i-1] + 1;
+    for (i=n-2; i>=0; i--)
+        if ( level[i] > level[i+1] + 1 ) level[i] = level[i+1] + 1;
+    //cells and edges of each level, keeping the memory of earlier levels when reset
+    long lmax = 0;
+    for (i=0; i<n; i++) if ( level[i] > lmax ) lmax = level[i];
+    for (unsigned long l=0; l<lcell.size(); l++) {
+        lcell[l].clear();
+        ledge[l].clear();
+    }
+    lcell.resize(lmax + 1);
+    ledge.resize(lcell.size());
+    for (i=0; i<n; i++) lcell[level[i]].push_back(i);
+    ledge[level[0]].push_back(0);
+    for (i=1; i<n; i++) ledge[level[i] < level[i-1] ? level[i] : level[i-1]].push_back(i);
+    ledge[level[n-1]].push_back(n);
+    //multirate work arrays
+    if ( lcell.size() > 1 ) {
+        tcell.resize(n);
+        Ea.resize(n);
+        Eb.resize(n);
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -143,6 +260,97 @@ double Heat::f_dTdt (double qb, double qt, double cap, double delz) {
     );
 }
 
+double Heat::f_Ts_radiative (double Tend) {
+    //Stefan-Boltzmann constant, SI units
+    const double sigma = 5.67e-8;
+    double es = stg.emissivity*sigma;
+    double dz = delz[n-1]/2;
+    double Ts0, Ts1, f, df;
+    //warm start
+    Ts1 = std::isnan(Tsrad) ? Tend : Tsrad;
+    for (long j=0; j<NEWTON_MAX; j++) {
+        TELEMETRY_COUNT(tel.nnewton, 1);
+        Ts0 = Ts1;
+        //conduction minus radiation, scaled by dz, and its derivative
+        f = dz*(es*(Ts1*Ts1*Ts1*Ts1) - stg.Fabs) + k[n]*(Ts1 - Tend);
+        df = 4*dz*es*(Ts1*Ts1*Ts1) + k[n];
+        Ts1 -= f/df;
+        if ( fabs(Ts0 - Ts1) <= 1e-9*fabs(Ts1) ) break;
+    }
+    Tsrad = Ts1;
+    return(Ts1);
+}
+
+double Heat::f_H (long i, double Tin) {
+    return( c[i]*rho[i]*(Tin - stg.Tf) + (Tin > stg.Tf ? stg.LH : 0.0) );
+}
+
+double Heat::f_T_enthalpy (long i, double Hin) {
+    //frozen
+    if ( Hin < 0.0 ) return( stg.Tf + Hin/(c[i]*rho[i]) );
+    //thawed
+    if ( Hin > stg.LH ) return( stg.Tf + (Hin - stg.LH)/(c[i]*rho[i]) );
+    //partially thawed
+    return( stg.Tf );
+}
+
+double Heat::energy () {
+    double E = 0.0;
+    for (unsigned long i=0; i<H.size(); i++) E += H[i]*delz[i];
+    return(E);
+}
+
+double Heat::surface_temperature (double tin, const double *Tin) {
+    if ( stg.radiative ) return( f_Ts_radiative(Tin[n-1]) );
+    return( f_Ts(tin, stg.Tsa, stg.Tsb, stg.Tsc) );
+}
+
+void Heat::update_fluxes (double *Tin, double tin) {
+
+    long i;
+
+    dTdz[0] = -f_qgeo(stg.qgeo0, tin)/k[0];
+    q[0] = f_q(dTdz[0], k[0]);
+    for (i=1; i<n; i++) {
+        dTdz[i] = gefac[i]*(Tin[i] - Tin[i-1]);
+        q[i] = f_q(dTdz[i], k[i]);
+    }
+    dTdz[n] = (surface_temperature(tin, Tin) - Tin[n-1])/(delz[n-1]/2);
+    q[n] = f_q(dTdz[n], k[n]);
+}
+
+double Heat::probe (double depth) {
+    return( interp(zc.data(), this->get_sol(), -depth, n) );
+}
+
+double Heat::steady_state (double tin, double *Tout) {
+
+    long i, j;
+    double qgeo = f_qgeo(stg.qgeo0, tin);
+    //temperature drop across the half cell above the surface cell
+    double dTs = qgeo*(delz[n-1]/2)/k[n];
+    //surface cell temperature, where it matches its surface temperature, with secant iterations
+    double x0, x1, r0, r1, x2;
+    Tout[n-1] = x0 = this->get_sol()[n-1];
+    r0 = x0 - surface_temperature(tin, Tout) - dTs;
+    x1 = x0 - r0;
+    for (j=0; j<NEWTON_MAX; j++) {
+        Tout[n-1] = x1;
+        r1 = x1 - surface_temperature(tin, Tout) - dTs;
+        if ( (r1 == 0) || (r1 == r0) || (fabs(x1 - x0) <= 1e-12*fabs(x1)) ) break;
+        x2 = x1 - r1*(x1 - x0)/(r1 - r0);
+        x0 = x1;
+        r0 = r1;
+        x1 = x2;
+    }
+    Tout[n-1] = x1;
+    //every interior edge carries the geothermal flux
+    for (i=n-1; i>0; i--)
+        Tout[i-1] = Tout[i] + qgeo/(k[i]*gefac[i]);
+
+    return( surface_temperature(tin, Tout) );
+}
+
 //------------------------------------------------------------------------------
 //ODE solver functions
 
@@ -153,16 +361,10 @@ void Heat::ode_fun (double *solin, double *fout) {
     //alias
     double *Tin = solin;
     double *dTdt = fout;
+    TELEMETRY_COUNT(tel.ncell, n);
 
     //cell edge gradients and fluxes
-    dTdz[0] = -f_qgeo(stg.qgeo0, this->get_t())/k[0];
-    q[0] = f_q(dTdz[0], k[0]);
-    for (i=1; i<n; i++) {
-        dTdz[i] = gefac[i]*(Tin[i] - Tin[i-1]);
-        q[i] = f_q(dTdz[i], k[i]);
-    }
-    dTdz[n] = (f_Ts(this->get_t(), stg.Tsa, stg.Tsb, stg.Tsc) - Tin[n-1])/(delz[n-1]/2);
-    q[n] = f_q(dTdz[n], k[n]);
+    update_fluxes(Tin, this->get_t());
 
     //time derivatives
     for (i=0; i<n; i++)
@@ -174,6 +376,728 @@ double Heat::dt_adapt () {
     return(stg.dtfac*dtmax);
 }
 
+//------------------------------------------------------------------------------
+//explicit and implicit solvers
+
+void Heat::step_explicit (double tin, double dt) {
+
+    long i;
+    //alias
+    double *T = this->get_sol();
+
+    //store the initial temperatures
+    for (i=0; i<n; i++) Tprev[i] = T[i];
+    //first stage
+    this->set_t(tin);
+    ode_fun(T, f1.data());
+    for (i=0; i<n; i++) Tstg[i] = T[i] + dt*f1[i];
+    //second stage
+    this->set_t(tin + dt);
+    ode_fun(Tstg.data(), f2.data());
+    for (i=0; i<n; i++) T[i] = Tprev[i] + dt*(f1[i] + f2[i])/2.0;
+}
+
+double Heat::spectral_radius (const double *Tin) {
+    double r = 0.0, a, b, x;
+    for (long i=0; i<n; i++) {
+        //conductances through the bottom and top of the cell, where the bottom flux is fixed
+        a = i == 0 ? 0.0 : k[i]*gefac[i];
+        b = i == n-1 ? k[n]/(delz[n-1]/2) : k[i+1]*gefac[i+1];
+        //diagonal plus off-diagonal magnitudes of the cell's row
+        x = 2.0*(a + b)/(f_cap(c[i], rho[i], Tin[i])*delz[i]);
+        if ( x > r ) r = x;
+    }
+    return(r);
+}
+
+void Heat::step_rkc (double tin, double dt) {
+
+    long i, j, s;
+    //alias
+    double *T = this->get_sol();
+    //Chebyshev parameters, the recurrence coefficients, and the stage times as fractions of the step
+    double w0, w1, t1, t2, arg;
+    double zj, zjm1, zjm2, dzj, dzjm1, dzjm2, d2zj, d2zjm1, d2zjm2;
+    double bj, bjm1, bjm2, ajm1, mu, nu, mus, thj, thjm1, thjm2;
+
+    //enough stages for the step to be stable
+    s = 1 + long(ceil(sqrt(1.0 + 1.54*dt*spectral_radius(T))));
+    nstage = s;
+    //damped Chebyshev polynomial
+    w0 = 1.0 + 2.0/(13.0*double(s*s));
+    t1 = w0*w0 - 1.0;
+    t2 = sqrt(t1);
+    arg = double(s)*log(w0 + t2);
+    w1 = sinh(arg)*t1/(cosh(arg)*double(s)*t2 - w0*sinh(arg));
+    bjm1 = 1.0/((2.0*w0)*(2.0*w0));
+    bjm2 = bjm1;
+
+    //store the initial temperatures and their derivatives
+    for (i=0; i<n; i++) Tprev[i] = T[i];
+    this->set_t(tin);
+    ode_fun(T, f1.data());
+    //first stage
+    mus = w1*bjm1;
+    for (i=0; i<n; i++) {
+        Tstg2[i] = Tprev[i];
+        Tstg[i] = Tprev[i] + dt*mus*f1[i];
+    }
+    thjm2 = 0.0;
+    thjm1 = mus;
+    zjm1 = w0;
+    zjm2 = 1.0;
+    dzjm1 = 1.0;
+    dzjm2 = 0.0;
+    d2zjm1 = 0.0;
+    d2zjm2 = 0.0;
+    //remaining stages, each replacing the one before the last
+    for (j=2; j<=s; j++) {
+        zj = 2.0*w0*zjm1 - zjm2;
+        dzj = 2.0*w0*dzjm1 - dzjm2 + 2.0*zjm1;
+        d2zj = 2.0*w0*d2zjm1 - d2zjm2 + 4.0*dzjm1;
+        bj = d2zj/(dzj*dzj);
+        ajm1 = 1.0 - zjm1*bjm1;
+        mu = 2.0*w0*bj/bjm1;
+        nu = -bj/bjm2;
+        mus = mu*w1/w0;
+        this->set_t(tin + thjm1*dt);
+        ode_fun(Tstg.data(), f2.data());
+        for (i=0; i<n; i++)
+            Tstg2[i] = mu*Tstg[i] + nu*Tstg2[i] + (1.0 - mu - nu)*Tprev[i] + dt*mus*(f2[i] - ajm1*f1[i]);
+        Tstg.swap(Tstg2);
+        thj = mu*thjm1 + nu*thjm2 + mus*(1.0 - ajm1);
+        //shift the recurrence
+        thjm2 = thjm1;
+        thjm1 = thj;
+        bjm2 = bjm1;
+        bjm1 = bj;
+        zjm2 = zjm1;
+        zjm1 = zj;
+        dzjm2 = dzjm1;
+        dzjm1 = dzj;
+        d2zjm2 = d2zjm1;
+        d2zjm1 = d2zj;
+    }
+    for (i=0; i<n; i++) T[i] = Tstg[i];
+    this->set_t(tin + dt);
+    //derivatives at the end of the step, for estimating the error of adaptive steps
+    if ( stg.adaptive ) ode_fun(T, f2.data());
+}
+
+void Heat::step_enthalpy (double tin, double dt) {
+
+    long i;
+    //alias
+    double *T = this->get_sol();
+    TELEMETRY_COUNT(tel.ncell, 2*n);
+
+    //store the initial temperatures and enthalpies
+    for (i=0; i<n; i++) Tprev[i] = T[i];
+    if ( stg.adaptive ) Hprev = H;
+    //first stage, with enthalpy changes from the edge fluxes
+    this->set_t(tin);
+    update_fluxes(T, tin);
+    for (i=0; i<n; i++) {
+        f1[i] = (q[i] - q[i+1])/delz[i];
+        Tstg[i] = f_T_enthalpy(i, H[i] + dt*f1[i]);
+    }
+    //second stage
+    this->set_t(tin + dt);
+    update_fluxes(Tstg.data(), tin + dt);
+    for (i=0; i<n; i++) {
+        f2[i] = (q[i] - q[i+1])/delz[i];
+        H[i] += dt*(f1[i] + f2[i])/2.0;
+        T[i] = f_T_enthalpy(i, H[i]);
+    }
+}
+
+double Heat::multirate_value (long i, double tin) {
+    //Tprev holds the enthalpy or temperature at the beginning of the cell's step and f1 its rate of change
+    double x = Tprev[i] + (tin - tcell[i])*f1[i];
+    if ( stg.enthalpy ) return( f_T_enthalpy(i, x) );
+    return(x);
+}
+
+void Heat::step_multirate (double tin, double dt) {
+
+    long i, j, l, m, nl;
+    unsigned long u;
+    //alias
+    double *T = this->get_sol();
+    //levels and substeps
+    long L = long(lcell.size());
+    long M = 1L << (L - 1);
+    double h = dt/double(M);
+    //substep times, flux steps, and the temperatures on both sides of an edge
+    double ts, d, fa, fb, Tl, Tu;
+
+    for (m=0; m<M; m++) {
+        ts = tin + h*double(m);
+        //number of levels beginning a step, the fastest ones
+        for (nl=0; (nl<L) && (m % (1L << nl) == 0); nl++);
+        //fluxes at the beginning of the substep through the edges of those levels, where the temperatures of slower cells in the middle of their steps are extrapolated
+        for (l=0; l<nl; l++) {
+            for (u=0; u<ledge[l].size(); u++) {
+                j = ledge[l][u];
+                if ( j == 0 ) {
+                    q[j] = f_q(-f_qgeo(stg.qgeo0, ts)/k[0], k[0]);
+                } else if ( j == n ) {
+                    q[j] = f_q((surface_temperature(ts, T) - T[n-1])/(delz[n-1]/2), k[n]);
+                } else {
+                    Tl = level[j-1] >= nl ? multirate_value(j-1, ts) : T[j-1];
+                    Tu = level[j] >= nl ? multirate_value(j, ts) : T[j];
+                    q[j] = f_q(gefac[j]*(Tu - Tl), k[j]);
+                }
+            }
+        }
+        //first stages of the cells beginning a step, predicting the end of their steps
+        for (l=0; l<nl; l++) {
+            d = h*double(1L << l);
+            //two flux evaluations for each cell of the level
+            TELEMETRY_COUNT(tel.ncell, 2*long(lcell[l].size()));
+            for (u=0; u<lcell[l].size(); u++) {
+                i = lcell[l][u];
+                tcell[i] = ts;
+                Ea[i] = 0.0;
+                Eb[i] = 0.0;
+                if ( stg.enthalpy ) {
+                    Tprev[i] = H[i];
+                    f1[i] = (q[i] - q[i+1])/delz[i];
+                    Tstg[i] = f_T_enthalpy(i, H[i] + d*f1[i]);
+                } else {
+                    Tprev[i] = T[i];
+                    cap[i] = f_cap(c[i], rho[i], T[i]);
+                    f1[i] = ((q[i] - q[i+1])/cap[i])/delz[i];
+                    Tstg[i] = T[i] + d*f1[i];
+                }
+            }
+        }
+        //trapezoidal flux steps through the edges, as long as the steps of their faster cells, added to the cells on both sides
+        for (l=0; l<nl; l++) {
+            d = h*double(1L << l);
+            for (u=0; u<ledge[l].size(); u++) {
+                j = ledge[l][u];
+                fa = d*q[j];
+                if ( j == 0 ) {
+                    fb = d*f_q(-f_qgeo(stg.qgeo0, ts + d)/k[0], k[0]);
+                } else if ( j == n ) {
+                    //only the surface cell of the predicted temperatures is current
+                    fb = d*f_q((surface_temperature(ts + d, Tstg.data()) - Tstg[n-1])/(delz[n-1]/2), k[n]);
+                } else {
+                    Tl = level[j-1] > l ? multirate_value(j-1, ts + d) : Tstg[j-1];
+                    Tu = level[j] > l ? multirate_value(j, ts + d) : Tstg[j];
+                    fb = d*f_q(gefac[j]*(Tu - Tl), k[j]);
+                }
+                if ( j < n ) {
+                    Ea[j] += fa;
+                    Eb[j] += fb;
+                }
+                if ( j > 0 ) {
+                    Ea[j-1] -= fa;
+                    Eb[j-1] -= fb;
+                }
+            }
+        }
+        //finish the steps of levels ending with this substep
+        for (l=0; (l<L) && ((m + 1) % (1L << l) == 0); l++) {
+            for (u=0; u<lcell[l].size(); u++) {
+                i = lcell[l][u];
+                if ( stg.enthalpy ) {
+                    H[i] = Tprev[i] + (Ea[i] + Eb[i])/(2.0*delz[i]);
+                    T[i] = f_T_enthalpy(i, H[i]);
+                } else {
+                    //capacities at the beginning and end of the step, as in step_explicit
+                    T[i] = Tprev[i] + (Ea[i]/cap[i] + Eb[i]/f_cap(c[i], rho[i], Tstg[i]))/(2.0*delz[i]);
+                }
+            }
+        }
+    }
+    this->set_t(tin + dt);
+}
+
+double Heat::step_error (double dt) {
+
+    //alias
+    double *T = this->get_sol();
+    long i;
+    //largest scaled error, a cell's error, and the apparent capacity window
+    double err = 0.0, e, w = stg.ahcw/2.0;
+
+    for (i=0; i<n; i++) {
+        if ( stg.implicit ) {
+            e = fabs(T[i] - Tprev[i] - dt*f1[i])/2.0;
+        } else if ( stg.rkc ) {
+            e = fabs(12.0*(Tprev[i] - T[i]) + 6.0*dt*(f1[i] + f2[i]))/15.0;
+        } else {
+            e = dt*fabs(f2[i] - f1[i])/2.0;
+            //enthalpy derivatives
+            if ( stg.enthalpy ) e /= c[i]*rho[i];
+        }
+        e /= stg.atol + stg.rtol*fabs(T[i]);
+        err = e > err ? e : err;
+    }
+    //resolve the apparent capacity window
+    if ( !stg.enthalpy && (stg.LH > 0) ) {
+        for (i=0; i<n; i++) {
+            if ( (fabs(Tprev[i] - stg.Tf) <= w) || (fabs(T[i] - stg.Tf) <= w) || ((Tprev[i] < stg.Tf) != (T[i] < stg.Tf)) ) {
+                e = fabs(T[i] - Tprev[i])/stg.ahcw;
+                err = e > err ? e : err;
+            }
+        }
+    }
+
+    return(err);
+}
+
+bool Heat::step_implicit (double tin, double dt) {
+
+    long i, j;
+    //alias
+    double *T = this->get_sol();
+    //implicitness
+    double th = stg.theta;
+    //end of the step
+    double tout = tin + dt;
+    //boundary conditions, edge conductances, and capacity terms
+    double qgeo, Ts, a, m;
+    bool converged = false;
+
+    //store the initial temperatures and their fluxes
+    for (i=0; i<n; i++) Tprev[i] = T[i];
+    update_fluxes(T, tin);
+    //derivatives at the beginning of the step, for estimating the error of adaptive steps
+    if ( stg.adaptive )
+        for (i=0; i<n; i++) f1[i] = f_dTdt(q[i], q[i+1], f_cap(c[i], rho[i], Tprev[i]), delz[i]);
+    //geothermal flux at the end of the step
+    qgeo = f_qgeo(stg.qgeo0, tout);
+
+    for (j=0; (j<stg.npicard) && !converged; j++) {
+        TELEMETRY_COUNT(tel.npicard, 1);
+        //surface temperature, which may depend on the current iterate
+        Ts = surface_temperature(tout, T);
+        //assemble the tridiagonal system
+        for (i=0; i<n; i++) {
+            //capacity evaluated at the current iterate
+            cap[i] = f_cap(c[i], rho[i], T[i]);
+            m = cap[i]*delz[i]/dt;
+            tdd[i] = m;
+            tdr[i] = m*Tprev[i] + (1.0 - th)*(q[i] - q[i+1]);
+            //bottom edge of the cell
+            if ( i == 0 ) {
+                tdl[i] = 0.0;
+                tdr[i] += th*qgeo;
+            } else {
+                a = th*k[i]*gefac[i];
+                tdl[i] = -a;
+                tdd[i] += a;
+            }
+            //top edge of the cell
+            if ( i == n-1 ) {
+                a = th*k[n]/(delz[n-1]/2);
+                tdu[i] = 0.0;
+                tdd[i] += a;
+                tdr[i] += a*Ts;
+            } else {
+                a = th*k[i+1]*gefac[i+1];
+                tdu[i] = -a;
+                tdd[i] += a;
+            }
+        }
+        //solve for the new iterate
+        solve_tridiag(tdl.data(), tdd.data(), tdu.data(), tdr.data(), n);
+        for (i=0; i<n; i++) T[i] = tdr[i];
+        //the iterate is a solution if the coefficients it implies are unchanged
+        converged = fabs(surface_temperature(tout, T) - Ts) <= 1e-6*stg.dTstep;
+        for (i=0; (i<n) && converged; i++)
+            if ( fabs(f_cap(c[i], rho[i], T[i]) - cap[i]) > 1e-9*cap[i] )
+                converged = false;
+    }
+
+    return(converged);
+}
+
+void Heat::solve (double tint, unsigned long nsnap, const char *dirout) {
+
+    TELEMETRY_TIME(tel.tsolve);
+    long i;
+    unsigned long isnap;
+    //alias
+    double *T = this->get_sol();
+    //times and steps
+    double t0 = this->get_t();
+    double tsnap, tin, h, dT, dTm, r, err;
+    bool accept, reject;
+
+    if ( nsnap < 2 )
+        print_exit("solves need at least two snaps, for the initial and final states");
+    if ( stg.enthalpy && stg.implicit )
+        print_exit("the enthalpy formulation is only available with explicit steps (implicit = false)");
+    if ( stg.adaptive && !stg.implicit && (lcell.size() > 1) )
+        print_exit("adaptive steps aren't available with multirate steps (nlevel > 1)");
+    if ( stg.rkc && (stg.implicit || stg.enthalpy || (lcell.size() > 1)) )
+        print_exit("Runge-Kutta-Chebyshev steps aren't available with implicit, enthalpy, or multirate (nlevel > 1) steps");
+
+    //the explicit stability limit, which is also the smallest implicit step worth rejecting
+    double dtmin = stg.dtfac*dtmax;
+    //whether steps are sized for accuracy instead of stability, by the implicit and Runge-Kutta-Chebyshev solvers
+    bool longstep = stg.implicit || stg.rkc;
+    //largest implicit step, so that the trackers resolve the whole integration, unless the steps are sized by their error, when only snaps limit them
+    double dtlim = longstep ? (stg.adaptive ? tint : tint/stg.nmaxout) : dtmin;
+    //largest step RKC_SMAX Runge-Kutta-Chebyshev stages can take
+    if ( stg.rkc ) {
+        dT = ((RKC_SMAX - 1.0)*(RKC_SMAX - 1.0) - 1.0)/(1.54*spectral_radius(T));
+        if ( dtlim > dT ) dtlim = dT;
+    }
+    //initial step size
+    double dt = dtmin < dtlim ? dtmin : dtlim;
+    //smallest step that can be rejected, below which adaptive explicit (including Runge-Kutta-Chebyshev) steps are accepted anyway
+    double dtfloor = stg.adaptive && !stg.implicit ? ADAPT_FLOOR*dtmin : dtmin;
+    //multirate explicit steps are as long as the steps of the slowest level
+    bool multirate = !stg.implicit && (lcell.size() > 1);
+    if ( multirate ) dt = dtmin*double(1L << (lcell.size() - 1));
+
+    //pick up where a killed run left off, if checkpointing
+    std::string fnck = std::string(dirout) + "/" + this->get_name() + "_checkpoint";
+    if ( (stg.checkpoint > 0) && load_checkpoint(fnck, tint, nsnap, t0, isnap, dt) ) {
+        std::cout << this->get_name() << ": resuming from checkpoint at t = " << this->get_t() << std::endl;
+    } else {
+        //equilibrium with the boundary conditions, if requested
+        if ( stg.steady ) steady_state(t0, T);
+        //enthalpies of the initial temperatures
+        if ( stg.enthalpy ) {
+            H.resize(n);
+            for (i=0; i<n; i++) H[i] = f_H(i, T[i]);
+        }
+        //initial fluxes, events, static output, and first snap
+        update_fluxes(T, t0);
+        start_events(t0);
+        diag.start(t0, q[n]);
+        write_static(dirout);
+        after_snap(dirout, 0, t0);
+        isnap = 1;
+    }
+    auto tck = std::chrono::steady_clock::now();
+
+    for (; (isnap<nsnap) && !halt; isnap++) {
+        //time of the next snap
+        tsnap = t0 + tint*double(isnap)/double(nsnap - 1);
+        while ( (this->get_t() < tsnap) && !halt ) {
+            //don't step past the snap
+            tin = this->get_t();
+            h = dt < tsnap - tin ? dt : tsnap - tin;
+            if ( stg.implicit ) {
+                //take the step, halving failed ones down to the stability limit
+                accept = step_implicit(tin, h);
+                if ( !accept && (h > dtmin) ) {
+                    for (i=0; i<n; i++) T[i] = Tprev[i];
+                    dt = h/2;
+                    continue;
+                }
+            } else if ( stg.rkc ) {
+                step_rkc(tin, h);
+            } else if ( multirate ) {
+                step_multirate(tin, h);
+            } else if ( stg.enthalpy ) {
+                step_enthalpy(tin, h);
+            } else {
+                step_explicit(tin, h);
+            }
+            //size the next step, unless explicit steps are fixed at the stability limit
+            if ( longstep || stg.adaptive ) {
+                if ( stg.adaptive ) {
+                    //ratio of the next step to this one, from the local error estimate, which is second order in the step size for Runge-Kutta-Chebyshev steps and first order otherwise
+                    err = step_error(h);
+                    r = err > 0 ? 0.9*pow(err, stg.rkc ? -1.0/3.0 : -0.5) : INFINITY;
+                    reject = err > 1.0;
+                } else {
+                    //largest temperature change
+                    dTm = 0.0;
+                    for (i=0; i<n; i++) {
+                        dT = fabs(T[i] - Tprev[i]);
+                        if ( dT > dTm ) dTm = dT;
+                    }
+                    //ratio of the accuracy target to the actual change
+                    r = dTm > 0 ? stg.dTstep/dTm : INFINITY;
+                    //reject steps that are far too large
+                    reject = r < 0.5;
+                }
+                if ( reject && (h > dtfloor) ) {
+                    //explicit steps leave the time at the end of the step
+                    this->set_t(tin);
+                    for (i=0; i<n; i++) T[i] = Tprev[i];
+                    if ( stg.enthalpy ) H = Hprev;
+                    dt = h*r;
+                    if ( dt < dtfloor ) dt = dtfloor;
+                    continue;
+                }
+                //next step size, from the change over this one
+                if ( h < dt ) {
+                    if ( h*r < dt ) dt = h*r;
+                } else {
+                    dt = h*(r < 2.0 ? r : 2.0);
+                }
+                if ( dt < dtfloor ) dt = dtfloor;
+                if ( dt > dtlim ) dt = dtlim;
+            }
+            //advance the time, landing exactly on snaps
+            this->set_t( h < tsnap - tin ? tin + h : tsnap );
+            hstep = h;
+            nstep++;
+            TELEMETRY_COUNT(tel.nstep, 1);
+            after_step(this->get_t());
+            //periodic checkpoint
+            if ( (stg.checkpoint > 0) && (std::chrono::duration<double>(std::chrono::steady_clock::now() - tck).count() > stg.checkpoint) ) {
+                save_checkpoint(fnck, tint, nsnap, t0, isnap, dt);
+                tck = std::chrono::steady_clock::now();
+            }
+        }
+        update_fluxes(T, this->get_t());
+        after_snap(dirout, isnap, this->get_t());
+    }
+
+    write_trackers(dirout);
+    //the output is complete, so the checkpoint is no longer needed
+    if ( stg.checkpoint > 0 ) remove(fnck.c_str());
+}
+
+void Heat::step_fixed (double tin, double dt) {
+
+    if ( stg.implicit ) {
+        if ( !step_implicit(tin, dt) && (dt > stg.dtfac*dtmax) ) {
+            double *T = this->get_sol();
+            for (long i=0; i<n; i++) T[i] = Tprev[i];
+            step_fixed(tin, dt/2);
+            step_fixed(tin + dt/2, dt/2);
+        }
+        this->set_t(tin + dt);
+    } else if ( stg.rkc ) {
+        step_rkc(tin, dt);
+    } else if ( lcell.size() > 1 ) {
+        step_multirate(tin, dt);
+    } else {
+        step_explicit(tin, dt);
+    }
+}
+
+void Heat::period_map (const double *Tin, double t0, double period, long nper, double *Tout) {
+
+    long i;
+    double *T = this->get_sol();
+    double h = period/double(nper);
+
+    for (i=0; i<n; i++) T[i] = Tin[i];
+    Tsrad = NAN;
+    for (i=0; i<nper; i++) step_fixed(t0 + double(i)*h, h);
+    for (i=0; i<n; i++) Tout[i] = T[i];
+    nperiod++;
+}
+
+void Heat::solve_periodic (double period, unsigned long nsnap, const char *dirout) {
+
+    long i, j;
+    double *T = this->get_sol();
+    double t0 = this->get_t();
+    double h, eta, eps, xnorm, vnorm, lam, r;
+
+    if ( !(period > 0) )
+        print_exit("periodic solves need a positive period");
+    if ( stg.enthalpy )
+        print_exit("the enthalpy formulation isn't available with periodic solves");
+
+    //number of equal steps in a period
+    double dtmin = stg.dtfac*dtmax;
+    if ( stg.implicit || stg.rkc ) {
+        h = period/stg.nmaxout;
+        if ( stg.rkc ) {
+            r = ((RKC_SMAX - 1.0)*(RKC_SMAX - 1.0) - 1.0)/(1.54*spectral_radius(T));
+            if ( h > r ) h = r;
+        }
+    } else {
+        h = dtmin*double(1L << (lcell.size() - 1));
+    }
+    long nper = long(ceil(period/h));
+
+    //the steady state of the forcing at the starting time may be closer to the cycle than the current temperatures
+    if ( stg.steady ) steady_state(t0, T);
+    //current guess, its map, residual, and Newton step
+    std::vector<double> x(T, T + n), P(n), F(n), d(n), xt(n), Pt(n), Ft(n);
+    auto maxabs = [this](const std::vector<double> &v) {
+        double m = 0.0;
+        for (long i=0; i<n; i++) if ( fabs(v[i]) > m ) m = fabs(v[i]);
+        return(m);
+    };
+    nshoot = 0;
+    nperiod = 0;
+    period_map(x.data(), t0, period, nper, P.data());
+    for (i=0; i<n; i++) F[i] = P[i] - x[i];
+    pres = maxabs(F);
+
+    //products with the Jacobian of the residual, (dP/dx - I)*v, by finite differences
+    auto jac = [&](const double *v, double *Jv) {
+        xnorm = 0.0;
+        vnorm = 0.0;
+        for (long i=0; i<n; i++) {
+            xnorm += x[i]*x[i];
+            vnorm += v[i]*v[i];
+        }
+        eps = sqrt(DBL_EPSILON)*(1.0 + sqrt(xnorm))/sqrt(vnorm);
+        for (long i=0; i<n; i++) xt[i] = x[i] + eps*v[i];
+        period_map(xt.data(), t0, period, nper, Pt.data());
+        for (long i=0; i<n; i++) Jv[i] = (Pt[i] - P[i])/eps - v[i];
+    };
+
+    while ( (pres > stg.ptol) && (nshoot < SHOOT_MAX) ) {
+        //solve for the Newton step, only as accurately as the tolerance needs
+        eta = 0.1*stg.ptol/pres;
+        if ( eta > 0.1 ) eta = 0.1;
+        for (i=0; i<n; i++) Ft[i] = -F[i];
+        gmres(jac, Ft.data(), d.data(), n, stg.nkrylov, eta);
+        //take the step, halving it if the residual grows, which latent heat can cause
+        lam = 1.0;
+        for (j=0; j<5; j++) {
+            for (i=0; i<n; i++) xt[i] = x[i] + lam*d[i];
+            period_map(xt.data(), t0, period, nper, Pt.data());
+            for (i=0; i<n; i++) Ft[i] = Pt[i] - xt[i];
+            r = maxabs(Ft);
+            if ( r < pres ) break;
+            lam /= 2;
+        }
+        //a direction that doesn't lower the residual isn't taken, and the iterations stop
+        if ( !(r < pres) ) {
+            std::cout << this->get_name() << ": periodic solve stalled after " << nshoot << " Newton iterations, no step along the GMRES direction reduces the residual" << std::endl;
+            break;
+        }
+        x.swap(xt);
+        P.swap(Pt);
+        F.swap(Ft);
+        pres = r;
+        nshoot++;
+    }
+    if ( pres > stg.ptol )
+        std::cout << this->get_name() << ": periodic solve not converged after " << nshoot << " Newton iterations, temperatures change by up to " << pres << " K over a period" << std::endl;
+
+    //record one cycle of the periodic state, which the steady setting mustn't replace
+    for (i=0; i<n; i++) T[i] = x[i];
+    this->set_t(t0);
+    Tsrad = NAN;
+    bool steady = stg.steady;
+    stg.steady = false;
+    solve(period, nsnap, dirout);
+    stg.steady = steady;
+}
+
+void Heat::save_checkpoint (std::string fn, double tint, unsigned long nsnap, double t0, unsigned long isnap, double dt) {
+
+    //everything written so far has to be on disk before the checkpoint is
+    if ( writer != NULL ) writer->flush();
+    if ( archive != NULL ) archive->flush();
+
+    CheckpointWriter ck(fn);
+    //which integration
+    ck.put(this->get_name());
+    ck.put(n);
+    ck.put(tint);
+    ck.put(long(nsnap));
+    //where it is
+    ck.put(t0);
+    ck.put(long(isnap));
+    ck.put(this->get_t());
+    ck.put(dt);
+    ck.put(long(this->get_nstep()));
+    ck.put(long(this->get_neval()));
+    ck.put(long(halt));
+    ck.put(Tsrad);
+    ck.put(this->get_sol(), n);
+    ck.put(H);
+    ck.put(tsnap);
+    //trackers and events
+    t.save(ck);
+    Tmax.save(ck);
+    Tmin.save(ck);
+    Ts.save(ck);
+    qs.save(ck);
+    dts.save(ck);
+    diag.save(ck);
+    ck.put(long(events.size()));
+    for (unsigned long j=0; j<events.size(); j++)
+        events[j].save(ck);
+    ck.put(long(reducers.size()));
+    for (unsigned long j=0; j<reducers.size(); j++)
+        reducers[j].save(ck);
+    ck.close();
+}
+
+bool Heat::load_checkpoint (std::string fn, double tint, unsigned long nsnap, double &t0, unsigned long &isnap, double &dt) {
+
+    CheckpointReader ck(fn);
+    std::string name;
+    //a checkpoint of some other integration is ignored
+    if ( !ck.get(name) || (name != this->get_name()) ) return(false);
+    if ( !ck.expect(n) || !ck.expect(tint) || !ck.expect(long(nsnap)) ) return(false);
+
+    //past this point, the checkpoint is for this integration and must be complete
+    double t0_, tin, dt_, Tsrad_;
+    long isnap_, nstep_, neval_, halt_;
+    std::vector<double> tsnap_, H_;
+    bool good = ck.get(t0_) && ck.get(isnap_) && ck.get(tin) && ck.get(dt_)
+             && ck.get(nstep_) && ck.get(neval_) && ck.get(halt_) && ck.get(Tsrad_)
+             && ck.get(this->get_sol(), n) && ck.get(H_) && ck.get(tsnap_)
+             && t.load(ck) && Tmax.load(ck) && Tmin.load(ck) && Ts.load(ck) && qs.load(ck) && dts.load(ck)
+             && diag.load(ck) && ck.expect(long(events.size()));
+    for (unsigned long j=0; (j<events.size()) && good; j++)
+        good = events[j].load(ck);
+    good = good && ck.expect(long(reducers.size()));
+    for (unsigned long j=0; (j<reducers.size()) && good; j++)
+        good = reducers[j].load(ck);
+    if ( !good ) print_exit(("checkpoint " + fn + " is damaged or doesn't match the integration, remove it to start over").c_str());
+
+    t0 = t0_;
+    isnap = (unsigned long)isnap_;
+    dt = dt_;
+    this->set_t(tin);
+    nstep = nstep_;
+    neval = neval_;
+    halt = halt_ != 0;
+    Tsrad = Tsrad_;
+    H = H_;
+    tsnap = tsnap_;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+//events
+
+double Heat::event_quantity (const Event &e, double tin) {
+    double *T = this->get_sol();
+    switch ( e.kind ) {
+        case event_Tmin:
+            return( min(T, n) );
+        case event_Tmax:
+            return( max(T, n) );
+        case event_probe:
+            return( probe(e.depth) );
+        case event_qs:
+            return( surface_flux(surface_temperature(tin, T), T[n-1]) );
+    }
+    return(NAN);
+}
+
+void Heat::start_events (double tin) {
+    halt = false;
+    for (unsigned long j=0; j<events.size(); j++)
+        events[j].start(tin, event_quantity(events[j], tin));
+    for (unsigned long j=0; j<reducers.size(); j++)
+        reducers[j].start(tin, event_quantity(reducers[j].event, tin));
+}
+
+void Heat::check_events (double tin) {
+    for (unsigned long j=0; j<events.size(); j++)
+        if ( events[j].check(tin, event_quantity(events[j], tin)) && events[j].terminal )
+            halt = true;
+    for (unsigned long j=0; j<reducers.size(); j++)
+        reducers[j].update(tin, event_quantity(reducers[j].event, tin));
+}
+
 //------------------------------------------------------------------------------
 //extras
 
@@ -181,58 +1105,117 @@ void Heat::before_solve () {
 	//initialize by taking a zero step
     this->step(0.0);
 	//write static physical variables
-    std::string name = this->get_name();
-    std::string dirout = this->get_dirout();
+    write_static(this->get_dirout());
+    //begin monitoring events, which can't stop libode's solvers
+    start_events(this->get_t());
+    //and diagnostics
+    update_fluxes(this->get_sol(), this->get_t());
+    diag.start(this->get_t(), q[n]);
+}
+
+void Heat::write_static (std::string dirout) {
     if ( stg.rho )
-        write_double(dirout + "/" + name + "_rho", rho);
+        output(dirout, "rho", rho);
     if ( stg.c )
-        write_double(dirout + "/" + name + "_c", c);
+        output(dirout, "c", c);
     if ( stg.k )
-        write_double(dirout + "/" + name + "_k", k);
+        output(dirout, "k", k);
     if ( stg.cap )
-        write_double(dirout + "/" + name + "_cap", cap);
+        output(dirout, "cap", cap);
 }
 
 void Heat::after_snap (std::string dirout, long isnap, double tin) {
-    std::string name = this->get_name();
-    std::string i = int_to_string(isnap);
     if ( stg.T )
-        write_double(dirout + "/" + name + "_T_" + i, this->get_sol(), n);
+        output(dirout, "T", isnap, tin, this->get_sol(), n);
     if ( stg.dTdz )
-        write_double(dirout + "/" + name + "_dTdz_" + i, dTdz);
+        output(dirout, "dTdz", isnap, tin, dTdz.data(), long(dTdz.size()));
     if ( stg.q )
-        write_double(dirout + "/" + name + "_q_" + i, q);
+        output(dirout, "q", isnap, tin, q.data(), long(q.size()));
     if ( stg.tsnap )
         tsnap.push_back( tin );
 }
 
 void Heat::after_step (double tin) {
     double *T = this->get_sol();
+    if ( !events.empty() || !reducers.empty() )
+        check_events(tin);
     if ( stg.Tmax )
-        Tmax.push_back( max(T, n) );
+        Tmax.push( max(T, n) );
     if ( stg.Tmin )
-        Tmin.push_back( min(T, n) );
+        Tmin.push( min(T, n) );
     if ( stg.Ts )
-        Ts.push_back( f_Ts(tin, stg.Tsa, stg.Tsb, stg.Tsc) );
+        Ts.push( surface_temperature(tin, T) );
     if ( stg.qs )
-        qs.push_back( f_q((f_Ts(tin, stg.Tsa, stg.Tsb, stg.Tsc) - T[n-1])/(delz[n-1]/2), k[0]) );
+        qs.push( surface_flux(surface_temperature(tin, T), T[n-1]) );
     if ( stg.t )
-        t.push_back( tin );
+        t.push( tin );
+    if ( stg.dt )
+        dts.push( hstep );
+    if ( diag.active() ) {
+        double Tsn = surface_temperature(tin, T);
+        diag.update(tin, T, 1, Tsn, surface_flux(Tsn, T[n-1]));
+    }
 }
 
 void Heat::after_solve () {
-    std::string name = this->get_name();
-    std::string dirout = this->get_dirout();
+    write_trackers(this->get_dirout());
+}
+
+void Heat::write_trackers (std::string dirout) {
     if ( stg.Tmax )
-        write_double(dirout + "/" + name + "_Tmax", subsample(Tmax, stg.nmaxout));
+        output(dirout, "Tmax", Tmax.values());
     if ( stg.Tmin )
-        write_double(dirout + "/" + name + "_Tmin", subsample(Tmin, stg.nmaxout));
+        output(dirout, "Tmin", Tmin.values());
     if ( stg.Ts )
-        write_double(dirout + "/" + name + "_Ts", subsample(Ts, stg.nmaxout));
+        output(dirout, "Ts", Ts.values());
     if ( stg.qs )
-        write_double(dirout + "/" + name + "_qs", subsample(qs, stg.nmaxout));
+        output(dirout, "qs", qs.values());
     if ( stg.t )
-        write_double(dirout + "/" + name + "_t", subsample(t, stg.nmaxout));
+        output(dirout, "t", t.values());
+    if ( stg.dt )
+        output(dirout, "dt", dts.values());
     if ( stg.tsnap )
-        write_double(dirout + "/" + name + "_tsnap", tsnap);
+        output(dirout, "tsnap", tsnap);
+    if ( !events.empty() ) {
+        std::vector<double> tcross;
+        for (unsigned long j=0; j<events.size(); j++)
+            tcross.push_back( events[j].tcross );
+        output(dirout, "events", tcross);
+    }
+    diag.write([&](const std::string &var, const std::vector<double> &v) { output(dirout, var, v); });
+}
+
+double Heat::cost_units (double tint) {
+    if ( stg.implicit ) return( 3.0*double(n)*double(stg.nmaxout) );
+    if ( stg.rkc ) {
+        //nmaxout steps, each taking as many evaluations as stages
+        double dt = tint/stg.nmaxout > stg.dtfac*dtmax ? tint/stg.nmaxout : stg.dtfac*dtmax;
+        double s = 1.0 + ceil(sqrt(1.0 + 1.54*dt*spectral_radius(this->get_sol())));
+        return( s*double(n)*ceil(tint/dt) );
+    }
+    //cells of each level are updated half as often as those of the level before it
+    double w = 0.0;
+    for (unsigned long l=0; l<lcell.size(); l++) w += double(lcell[l].size())/double(1L << l);
+    return( 2.0*w*ceil(tint/(stg.dtfac*dtmax)) );
+}
+
+double Heat::time_rhs (long nrep) {
+    std::vector<double> f(n);
+    //once to warm up
+    ode_fun(this->get_sol(), f.data());
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i=0; i<nrep; i++) ode_fun(this->get_sol(), f.data());
+    double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return( dt/(double(nrep)*double(n)) );
+}
+
+void Heat::output (std::string dirout, std::string var, long isnap, double tin, const double *a, long size) {
+    if ( !stg.trial_files ) return;
+    TELEMETRY_TIME(tel.twrite);
+    TELEMETRY_COUNT(tel.nbyte, size*long(sizeof(double)));
+    write_output(archive, writer, dirout, this->get_name(), var, isnap, tin, a, size);
+}
+
+void Heat::output (std::string dirout, std::string var, const std::vector<double> &v) {
+    output(dirout, var, -1, NAN, v.data(), long(v.size()));
 }
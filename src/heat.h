@@ -11,12 +11,36 @@ The code runs through three classes/structs. To perform an integration:
     1. Create a Settings struct by reading values from a text file. An example settings file is included in the repository as settings.txt. The Settings struct contains physical parameters, integration settigns, and grid specifications.
     2. Create a Grid object using values in the Settings struct or with other specifications.
     3. Construct a Heat object with your Settings and Grid objects.
-    4. Call one of the Heat object's integrating methods (solve_fixed or solve_adaptive). These are explained in the documentation for [libode](https://github.com/wordsworthgroup/libode). Adaptive solves will choose the time step based on the stability limit of the solver.
+    4. Call Heat::solve, which runs its own time loop and writes the trackers and snaps, or Heat::solve_periodic for periodic forcing. The integrating methods inherited from libode (solve_fixed or solve_adaptive) can also be called, as explained in the documentation for [libode](https://github.com/wordsworthgroup/libode).
 
-An example program for running a single integration is in the main.cc file. A convergence test is run by the main_test.cc program.
+The settings choose how Heat::solve steps:
+    - By default, explicit trapezoidal steps at the stability limit.
+    - With `implicit = true`, implicit tridiagonal steps, limited only by the `dTstep` accuracy target, snapshot times, and the resolution of the trackers.
+    - With `rkc = true`, explicit Runge-Kutta-Chebyshev steps sized like implicit ones, staying stable by adding stages instead of solving a system, so they work with any overridden physics.
+    - With `adaptive = true`, steps sized by an embedded estimate of their local error against `rtol` and `atol`.
+    - With `nlevel` above 1 on stretched grids, multirate explicit steps (Heat::step_multirate). Cells are grouped into levels whose stable steps differ by powers of two, so slow levels take fewer steps, and fluxes between levels stay conservative.
+    - With `enthalpy = true`, explicit steps of each cell's enthalpy, which conserve energy through latent heat.
+
+With `radiative = true`, the surface temperature balances conduction to the surface against radiation (emissivity and absorbed flux `Fabs`) instead of following Tsa, Tsb, and Tsc.
+
+Events (threshold crossings of the minimum or maximum temperature, a probe temperature, or the surface heat flux) can be registered with Heat::add_event. Their crossing times are written to the `<name>_events` file, and terminal events stop Heat::solve early. Reductions of the same quantities (first crossing, maximum, minimum, final value, or time integral) can be registered with Heat::add_reducer, and Sweep collects them into a summary table.
+
+Interior quantities that would otherwise need profile snaps (temperatures at probe depths, the depth of an isotherm and the thaw depth, the column's heat content, and the heat lost through the surface) are tracked after every step by Diagnostics when turned on in the settings.
+
+For periodic forcing, Heat::solve_periodic finds the periodic steady state by shooting and integrates one cycle of it.
+
+Output is written as one binary file per variable or, with `archive = true`, into one indexed Archive shared by a run. With `checkpoint` above zero, Heat::solve saves its state every `checkpoint` seconds of wall clock time and resumes from it when the same integration is run again.
+
+When the physics of a model is known at compile time, HeatKernel (heat_kernel.h) replaces the virtual physics functions with policy classes and a single vectorizable pass over the cells. Overriding the virtual functions of Heat remains the flexible path.
+
+For parameter sweeps over a shared grid that only need the base physics, the HeatBatch class integrates NLANE trials at once, vectorized across trials. The Sweep class expands ranges of settings given in a settings file (like `k0 = lin(1, 7, 7)`) into trials and integrates them in parallel, choosing HeatBatch when it can, or HeatLinear (heat_linear.h), which superposes trials differing only in Tsa, Tsb, and qgeo0 from one integration, when the problem is linear. Otherwise it takes a Heat object for each trial from a SolverPool (pool.h), which keeps one solver per thread and reuses it with Heat::reset when the grid doesn't change.
+
+An example program for running a single integration is in the main.cc file. A convergence test is run by the main_test.cc program, and main_verify.cc checks each solver, batched and superposed sweeps, and checkpoint restarts against reference integrations.
 */
 
 #include <cmath>
+#include <cfloat>
+#include <chrono>
 #include <cstdio>
 #include <string>
 #include <vector>
@@ -25,8 +49,27 @@ An example program for running a single integration is in the main.cc file. A co
 #include "io.h"
 #include "util.h"
 #include "grid.h"
+#include "event.h"
+#include "reducer.h"
+#include "archive.h"
+#include "writer.h"
+#include "tracker.h"
+#include "diagnostics.h"
+#include "telemetry.h"
 #include "settings.h"
 
+//!fraction of the explicit stability limit below which adaptive explicit steps are accepted regardless of their error estimate
+#define ADAPT_FLOOR 1e-6
+
+//!maximum number of stages of a Runge-Kutta-Chebyshev step, which limits its size
+#define RKC_SMAX 1000
+
+//!maximum Newton iterations of a radiative surface temperature solve
+#define NEWTON_MAX 50
+
+//!maximum Newton iterations of a periodic steady state solve
+#define SHOOT_MAX 20
+
 //header file for ODE integrator class
 #include "ode_trapz.h"
 
@@ -35,8 +78,14 @@ class Heat : public OdeTrapz {
 
 public:
 
-    //!constructs
-    Heat (Grid grid, Settings stgin);
+    //!constructs, sharing the grid's arrays instead of copying them
+    Heat (const Grid &grid, Settings stgin);
+    //!reinitializes the object for new settings on the same grid, as if it had just been constructed, without allocating memory
+    /*!
+    Properties, initial temperatures, stable steps, trackers, events, the solver time and step counts, and telemetry are all reset. The name, quietness, archive, and writer are kept. As in the constructor, properties and initial temperatures come from Heat's own physics functions, not overrides of them. The trackers only allocate if nmaxout is larger than before, and the multirate levels only if there are more of them.
+    \param[in] stgin new settings
+    */
+    void reset (Settings stgin);
 
     //!settings structure
     Settings stg;
@@ -44,22 +93,24 @@ public:
     //--------------
     //grid variables
 
+    //!the grid, holding a reference to the arrays viewed below
+    const Grid grid;
     //!number of cells
     const long n;
     //!length/depth of domain (m)
     const double dep;
     //!cell edge coordinates (m)
-    const std::vector<double> ze;
+    const GridView ze;
     //!cell center coordinates (m)
-    const std::vector<double> zc;
+    const GridView zc;
     //!cell width (m)
-    const std::vector<double> delz;
+    const GridView delz;
     //!cell widths used for stability calculations (m)
-    const std::vector<double> delze;
+    const GridView delze;
     //!factors for cell edge values
-    const std::vector<double> vefac;
+    const GridView vefac;
     //!factors for cell edge gradients
-    const std::vector<double> gefac;
+    const GridView gefac;
 
     //------------------
     //physical variables
@@ -88,21 +139,81 @@ public:
     //!maximum stable time step
     double dtmax;
 
+    //!time step level of each cell in multirate explicit steps, where level l steps 2^l times as far as level 0, which steps at the stability limit
+    std::vector<long> level;
+    //!cells in each time step level
+    std::vector< std::vector<long> > lcell;
+    //!edges in each time step level, the level of the faster cell next to the edge
+    std::vector< std::vector<long> > ledge;
+
+    //!temperatures at the beginning of an implicit step
+    std::vector<double> Tprev;
+    //!sub-diagonal of the implicit system
+    std::vector<double> tdl;
+    //!diagonal of the implicit system
+    std::vector<double> tdd;
+    //!super-diagonal of the implicit system
+    std::vector<double> tdu;
+    //!right hand side of the implicit system
+    std::vector<double> tdr;
+
+    //!first stage derivatives of an explicit step
+    std::vector<double> f1;
+    //!second stage derivatives of an explicit step
+    std::vector<double> f2;
+    //!first stage temperatures of an explicit step
+    std::vector<double> Tstg;
+    //!volumetric enthalpy of each cell in the enthalpy formulation, zero for frozen medium at Tf (J/m^3)
+    std::vector<double> H;
+    //!second to last stage temperatures of a Runge-Kutta-Chebyshev step
+    std::vector<double> Tstg2;
+    //!number of stages of the last Runge-Kutta-Chebyshev step
+    long nstage;
+    //!enthalpies at the beginning of an explicit step, restored when an adaptive step is rejected
+    std::vector<double> Hprev;
+    //!size of the last step taken by Heat::solve
+    double hstep;
+    //!time at the beginning of each cell's current multirate step
+    std::vector<double> tcell;
+    //!integrated fluxes into each cell at the beginning of its substeps, over its current multirate step (J/m^2)
+    std::vector<double> Ea;
+    //!integrated fluxes into each cell at the end of its substeps, over its current multirate step (J/m^2)
+    std::vector<double> Eb;
+
+    //!archive receiving all output, or NULL to write a file for each variable
+    Archive *archive;
+    //!background writer taking all output, or NULL to write on the integrating thread
+    Writer *writer;
+
+    //!performance counters, filled in when compiled with -DTELEMETRY
+    Telemetry tel;
+
+    //!registered events
+    std::vector<Event> events;
+    //!whether a terminal event has been found
+    bool halt;
+    //!registered reductions, whose results aren't written by Heat (see Sweep)
+    std::vector<Reducer> reducers;
+
     //--------
-    //trackers
-
-    //!time tracker
-    std::vector<double> t;
-    //!maximum temperature tracker
-    std::vector<double> Tmax;
-    //!minimum temperature tracker
-    std::vector<double> Tmin;
+    //trackers, each holding at most nmaxout values
+
+    //!time tracker, the time at the end of each bucket
+    Tracker t;
+    //!maximum temperature tracker, the maximum in each bucket
+    Tracker Tmax;
+    //!minimum temperature tracker, the minimum in each bucket
+    Tracker Tmin;
     //!surface temperature tracker
-    std::vector<double> Ts;
+    Tracker Ts;
     //!surface heat flux tracker
-    std::vector<double> qs;
+    Tracker qs;
+    //!step size tracker, the smallest step in each bucket
+    Tracker dts;
     //!snapshot times
     std::vector<double> tsnap;
+    //!probes, isotherm and thaw depths, heat content, and surface heat loss, tracked after every step if the settings turn them on, and written with the trackers
+    Diagnostics diag;
 
     //-------------------
     //physical parameters
@@ -119,6 +230,14 @@ public:
     virtual double f_c (double c0, double depth);
     //!medium thermal capacity
     virtual double f_cap (double c, double rho, double Tin);
+    //!surface temperature in radiation balance, where conduction to the surface carries the emitted minus absorbed flux (K)
+    /*!
+    Solves k*(Tend - Ts)/(delz/2) = emissivity*sigma*Ts^4 - Fabs for Ts with Newton's method, at most NEWTON_MAX iterations to a relative tolerance of 1e-9. The iteration starts from the previous solution, which is close to the new one from one evaluation to the next, so it usually takes one or two iterations.
+    \param[in] Tend temperature of the surface cell (K)
+    */
+    double f_Ts_radiative (double Tend);
+    //!last radiative surface temperature, starting the next solve (K)
+    double Tsrad;
 
     //------------------
     //physical functions
@@ -129,6 +248,29 @@ public:
     double f_q (double dTdz, double k);
     //!computes the time derivative of a cell, given fluxes on its sides
     double f_dTdt (double qb, double qt, double cap, double delz);
+    //!surface temperature of the solver, from f_Ts or, if the radiative setting is true, from f_Ts_radiative (K)
+    virtual double surface_temperature (double tin, const double *Tin);
+    //!heat flux through the surface edge, given the surface temperature and the surface cell's temperature, as update_fluxes computes it (W/m^2)
+    double surface_flux (double Tsin, double Ttop) { return( f_q((Tsin - Ttop)/(delz[n-1]/2), k[n]) ); }
+    //!computes gradients and fluxes at every cell edge, filling dTdz and q
+    void update_fluxes (double *Tin, double tin);
+    //!volumetric enthalpy of a cell at a temperature, with all latent heat released at Tf (J/m^3)
+    double f_H (long i, double Tin);
+    //!temperature of a cell with a volumetric enthalpy, the inverse of f_H, which is Tf for partially thawed cells (K)
+    double f_T_enthalpy (long i, double Hin);
+    //!total enthalpy of the column per unit area, in the enthalpy formulation (J/m^2)
+    double energy ();
+    //!computes the temperature at a depth, interpolated between cell centers (K)
+    double probe (double depth);
+    //!computes the steady state of the boundary conditions at a time, in which every cell edge carries the geothermal flux from f_qgeo, returning the surface temperature (K)
+    /*!
+    The steady state only depends on the conductivities in k, since capacities (and so latent heat) drop out, and every edge's flux is known, so the temperatures are found cell by cell down from the surface with the same edge conductances as update_fluxes. It's exact for any conductivity profile, to rounding. The surface temperature comes from surface_temperature, which may depend on the surface cell (radiative surfaces, or overrides of it), so the surface cell's temperature is found first with a secant iteration. Nothing else in the object is changed, except the warm start of radiative solves.
+    \param[in] tin time of the boundary conditions
+    \param[out] Tout steady temperature of each cell (K)
+    */
+    double steady_state (double tin, double *Tout);
+    //!sets the temperatures to the steady state of the boundary conditions at the current time
+    void set_steady () { steady_state(this->get_t(), this->get_sol()); }
 
     //--------------------
     //ODE solver functions
@@ -139,6 +281,149 @@ public:
     //!computes the next time step, based on the maximum diffusivity
     double dt_adapt ();
 
+    //-------------------------
+    //explicit and implicit solvers
+
+    //!takes a single explicit trapezoidal step, the same step as libode's OdeTrapz
+    /*!
+    The starting temperatures are kept in Tprev and the solver time is left at tin + dt.
+    \param[in] tin time at the beginning of the step
+    \param[in] dt size of the step
+    */
+    void step_explicit (double tin, double dt);
+    //!bounds the spectral radius of the ode function's Jacobian at a temperature profile by Gershgorin's theorem, using k, gefac, and the capacities from f_cap (1/s)
+    double spectral_radius (const double *Tin);
+    //!takes a single damped, second order Runge-Kutta-Chebyshev step, with enough stages to be stable at the step size
+    /*!
+    The number of stages s is 1 + ceil(sqrt(1 + 1.54*dt*rho)) for the spectral radius rho, so the stable step grows with s^2 while the work grows with s. The stages are computed with the three-term recurrence of Sommeijer et al.'s RKC, with damping 2/13, using only ode_fun, so any overridden physics works. The starting temperatures and derivatives are kept in Tprev and f1 and, for adaptive steps, the derivatives at the end of the step in f2. The solver time is left at tin + dt.
+    \param[in] tin time at the beginning of the step
+    \param[in] dt size of the step
+    */
+    void step_rkc (double tin, double dt);
+    //!takes a single explicit trapezoidal step of the enthalpy in each cell, then recovers temperatures with f_T_enthalpy
+    /*!
+    Enthalpy changes only by the fluxes through cell edges, so energy is conserved exactly (to rounding) no matter how far a cell steps through the phase change, unlike the apparent capacity of f_cap, which misses latent heat when a cell steps over the ahcw window. Fronts stay sharp on coarse cells, with partially thawed cells held at Tf. Capacities are c*rho, so f_cap isn't used.
+    \param[in] tin time at the beginning of the step
+    \param[in] dt size of the step
+    */
+    void step_enthalpy (double tin, double dt);
+    //!takes a single multirate explicit step, in which the cells of each time step level take trapezoidal steps at their own stability limit
+    /*!
+    The step is divided into 2^(L-1) substeps for L levels. At the beginning of each substep, the levels whose steps begin there take their first stage and the edges of those levels take trapezoidal flux steps as long as the steps of their faster neighbor. A slower cell in the middle of its step is extrapolated along its first stage, and its temperature array entry holds the beginning of its step, which is what surface_temperature sees for every cell but the surface one. Each edge's integrated flux is added to both of its cells, so the flux through an edge between levels leaves one cell and enters the other exactly, and cells are only updated at the end of their own steps. With the enthalpy setting, enthalpies are stepped instead of temperatures. With a single level, this is the same step as step_explicit or step_enthalpy.
+    \param[in] tin time at the beginning of the step
+    \param[in] dt size of the step
+    */
+    void step_multirate (double tin, double dt);
+    //!temperature of a cell in the middle of a multirate step, extrapolated from the beginning of its step along its first stage (K)
+    double multirate_value (long i, double tin);
+    //!estimates the local error of the last explicit or implicit step, relative to the adaptive tolerances, so that the step is within them if the estimate is at most one
+    /*!
+    Explicit steps are compared with the forward Euler step of their first stage, which is what the second stage adds, so the estimate is dt*|f2 - f1|/2 in each cell. Runge-Kutta-Chebyshev steps use RKC's estimate, |12*(Tprev - T) + 6*dt*(f1 + f2)|/15. Implicit steps are compared with a forward Euler step from the fluxes at the beginning of the step, so the estimate is |T - Tprev - dt*f1|/2, the local error of backward Euler, and an overestimate for Crank-Nicolson. Each cell's estimate is scaled by atol + rtol*|T|. With latent heat as an apparent capacity, cells that end the step on the other side of the freezing point, or that start or end it inside the ahcw window, also count their temperature change as a fraction of ahcw, so steps can't skip over the window and miss the latent heat.
+    \param[in] dt size of the step
+    */
+    double step_error (double dt);
+    //!takes a single implicit (theta method) step, returning false if the Picard iterations fail
+    /*!
+    The tridiagonal system is solved with the Thomas algorithm. Capacities and the surface temperature are iterated to consistency with the end of the step. The last iterate is left in the solution array, the starting temperatures are kept in Tprev, and the solver time is not changed.
+    \param[in] tin time at the beginning of the step
+    \param[in] dt size of the step
+    */
+    bool step_implicit (double tin, double dt);
+    //!integrates with explicit steps at the stability limit (multirate steps, if the nlevel setting makes more than one level) or, if the implicit setting is true, implicit steps sized by the dTstep accuracy target
+    /*!
+    With the enthalpy setting, explicit steps are taken by step_enthalpy, starting from enthalpies computed from the current temperatures. The enthalpy formulation isn't available with the implicit solver.
+    With the steady setting, the integration starts from the steady state of the boundary conditions at its starting time (see Heat::steady_state) instead of the current temperatures.
+    With the rkc setting, explicit steps are taken by step_rkc and sized like implicit steps, but no larger than RKC_SMAX stages allow.
+    With the adaptive setting, steps are sized by step_error and rejected if the estimate is above one, never exceeding the stability limit of explicit steps. Adaptive implicit steps aren't limited by nmaxout, only by snaps, so the trackers hold fewer values when the solution changes slowly. Multirate steps can't be adaptive.
+    The integration stops early, with a final snap, at the end of the step where a terminal event is found.
+    \param[in] tint duration of the integration
+    \param[in] nsnap number of snapshots, including the initial state
+    \param[in] dirout output directory
+    */
+    void solve (double tint, unsigned long nsnap, const char *dirout);
+
+    //!takes a single step with the solver chosen by the settings (implicit, rkc, multirate, or explicit), leaving the solver time at tin + dt
+    /*!
+    Failed implicit steps are split in half, down to the explicit stability limit.
+    \param[in] tin time at the beginning of the step
+    \param[in] dt size of the step
+    */
+    void step_fixed (double tin, double dt);
+    //!integrates one period with equal steps of step_fixed and no output, the map whose fixed point Heat::solve_periodic finds
+    /*!
+    The radiative surface solve isn't warm started from before the map, so the result depends only on the starting temperatures.
+    \param[in] Tin temperatures at the beginning of the period
+    \param[in] t0 time at the beginning of the period
+    \param[in] period length of the period
+    \param[in] nper number of steps
+    \param[out] Tout temperatures at the end of the period
+    */
+    void period_map (const double *Tin, double t0, double period, long nper, double *Tout);
+    //!finds the periodic steady state of periodic forcing (an overridden f_Ts, for example) by shooting, then integrates and writes one cycle of it with Heat::solve
+    /*!
+    The temperatures at the current time that return to themselves after one period are found by Newton's method on the period map. Each Newton system is solved with GMRES using at most nkrylov one-period integrations for products with the map's Jacobian, which are finite differences. The iterations stop when no cell's temperature changes by more than ptol over a period, or after SHOOT_MAX of them. Each Newton step is halved up to five times until it reduces the residual, and if none of them does, the last iterate is kept and the iterations stop, with a message. Only the few slowest modes of the column decay slowly over a period, so GMRES converges in about as many integrations as there are such modes. Without latent heat the problem is linear, and one or two Newton iterations are enough. Spinning up from the initial temperatures would take about as many periods as the column's diffusion time. Steps within a period are equal: explicit steps are at the stability limit (of the slowest level, for multirate steps), and implicit and Runge-Kutta-Chebyshev steps are nmaxout to a period. The recorded cycle is integrated by Heat::solve with the usual steps. The enthalpy formulation isn't available.
+    \param[in] period length of the forcing period
+    \param[in] nsnap number of snapshots over the recorded cycle, including the initial state
+    \param[in] dirout output directory
+    */
+    void solve_periodic (double period, unsigned long nsnap, const char *dirout);
+    //!number of Newton iterations of the last periodic solve
+    long nshoot;
+    //!number of one-period integrations of the last periodic solve, not counting the recorded cycle
+    long nperiod;
+    //!largest change of any cell's temperature over one period before the last periodic solve's recorded cycle (K)
+    double pres;
+
+    //!writes the state of Heat::solve to a checkpoint file, replacing any earlier one
+    /*!
+    Checkpoints hold the solver time and step counts, the solution, the current step size, the snap counter, the trackers, the events, and the reductions. They're written by Heat::solve every `checkpoint` seconds of wall clock time, to dirout/name_checkpoint, after the output so far has been flushed, and removed when the solve finishes.
+    \param[in] fn checkpoint file
+    \param[in] tint duration of the integration
+    \param[in] nsnap number of snapshots
+    \param[in] t0 starting time of the integration
+    \param[in] isnap number of the next snap
+    \param[in] dt current step size
+    */
+    void save_checkpoint (std::string fn, double tint, unsigned long nsnap, double t0, unsigned long isnap, double dt);
+    //!restores the state of Heat::solve from a checkpoint file, returning false if there isn't one for the same integration
+    /*!
+    The events and reductions must be registered, as they were for the checkpointed run, before loading.
+    \param[in] fn checkpoint file
+    \param[in] tint duration of the integration, which must match the checkpoint
+    \param[in] nsnap number of snapshots, which must match the checkpoint
+    \param[out] t0 starting time of the integration
+    \param[out] isnap number of the next snap
+    \param[out] dt current step size
+    */
+    bool load_checkpoint (std::string fn, double tint, unsigned long nsnap, double &t0, unsigned long &isnap, double &dt);
+
+    //!predicts the work of an integration, in cells times right-hand side evaluations, for scheduling
+    /*!
+    Explicit integrations take two evaluations per step at the stable time step, each cell at the step of its level in multirate integrations. Runge-Kutta-Chebyshev integrations are assumed to take nmaxout steps, each with as many evaluations as stages. Implicit integrations are assumed to take nmaxout steps of a few Picard iterations, since their steps depend on the solution. Events that stop integrations early are not predicted.
+    \param[in] tint duration of the integration
+    */
+    double cost_units (double tint);
+    //!times the right-hand side on the current state, as a pilot run for calibrating costs
+    /*!
+    \param[in] nrep number of evaluations to time
+    \return seconds per evaluation per cell
+    */
+    double time_rhs (long nrep);
+
+    //------
+    //events
+
+    //!registers an event to locate during integrations
+    void add_event (Event e) { events.push_back(e); }
+    //!registers a reduction to compute during integrations
+    void add_reducer (Reducer r) { reducers.push_back(r); }
+    //!computes the quantity monitored by an event
+    double event_quantity (const Event &e, double tin);
+    //!begins monitoring all events and reductions
+    void start_events (double tin);
+    //!checks all events at the end of a step, setting halt if a terminal event is found, and updates the reductions
+    void check_events (double tin);
+
     //------
     //extras
 
@@ -150,6 +435,31 @@ public:
     void after_step (double tin);
     //!does extra stuff after integrating
     void after_solve ();
+    //!writes static physical variables
+    virtual void write_static (std::string dirout);
+    //!writes the trackers
+    virtual void write_trackers (std::string dirout);
+    //!sends all output to an archive, which may be shared by many Heat objects, instead of separate files
+    void set_archive (Archive *a) { archive = a; }
+    //!hands all output to a background writer, which may be shared by many Heat objects
+    void set_writer (Writer *w) { writer = w; }
+    //!writes one output variable to the archive or, without one, to the file dirout/name_var (or dirout/name_var_isnap for snaps), unless the trial_files setting is off
+    /*!
+    \param[in] dirout output directory
+    \param[in] var variable name
+    \param[in] isnap snap number, or -1 if the variable isn't a snap
+    \param[in] tin snap time
+    \param[in] a values to write
+    \param[in] size number of values
+    */
+    void output (std::string dirout, std::string var, long isnap, double tin, const double *a, long size);
+    //!writes one output variable that isn't a snap
+    void output (std::string dirout, std::string var, const std::vector<double> &v);
+
+private:
+
+    //!sets up everything that depends on the settings, in arrays allocated by the constructor
+    void init (Settings &stgin);
 };
 
 #endif
@@ -0,0 +1,477 @@
+//! \file heat_batch.cc
+
+#include "heat_batch.h"
+
+HeatBatch::HeatBatch (const Grid &gridin, std::vector<Settings> stgs) :
+    n     (gridin.get_n()),
+    nact  (long(stgs.size())),
+    stg   (stgs),
+    grid  (gridin),
+    zc    (grid.get_zc()),
+    delz  (grid.get_delz()),
+    gefac (grid.get_gefac()) {
+
+    TELEMETRY_TIME(tel.tconstruct);
+    long i, w, l;
+
+    if ( (nact < 1) || (nact > NLANE) )
+        print_exit("a HeatBatch must be constructed with between 1 and NLANE settings");
+
+    //default names are the lane numbers
+    for (w=0; w<nact; w++) names.push_back( int_to_string(w) );
+
+    //-------------------------------------------------------
+    //lane parameters, with idle lanes copying the last trial
+
+    for (w=0; w<NLANE; w++) {
+        l = w < nact ? w : nact - 1;
+        k0[w] = stg[l].k0;
+        qgeo0[w] = stg[l].qgeo0;
+        Tsa[w] = stg[l].Tsa;
+        Tsb[w] = stg[l].Tsb;
+        Tsc[w] = stg[l].Tsc;
+        cap0[w] = stg[l].c0*stg[l].rho0;
+        LHw[w] = stg[l].LH/stg[l].ahcw;
+        Tf[w] = stg[l].Tf;
+        hw[w] = stg[l].ahcw/2.0;
+    }
+
+    //--------------------------------------------
+    //initial temperatures along linear geotherms
+
+    t = 0.0;
+    T.resize(n*NLANE);
+    k1.resize(n*NLANE);
+    k2.resize(n*NLANE);
+    Tstg.resize(n*NLANE);
+    for (i=0; i<n; i++)
+        for (w=0; w<NLANE; w++)
+            T[i*NLANE + w] = f_Ts(w, 0.0) + qgeo0[w]*(-zc[i])/k0[w];
+
+    //------------------------------------------------------
+    //maximum stable time steps, for uniform properties
+
+    GridView delze = grid.get_delze();
+    double dzmin = INFINITY;
+    for (i=0; i<n+1; i++)
+        if ( dzmin > delze[i] )
+            dzmin = delze[i];
+    for (w=0; w<NLANE; w++)
+        dtmax[w] = dzmin*dzmin/(2.0*k0[w]/cap0[w]);
+
+    //--------
+    //trackers
+
+    tt.assign(nact, Tracker(stg[0].nmaxout, tracker_last));
+    Tmax.assign(nact, Tracker(stg[0].nmaxout, tracker_max));
+    Tmin.assign(nact, Tracker(stg[0].nmaxout, tracker_min));
+    Ts.assign(nact, Tracker(stg[0].nmaxout, tracker_last));
+    qs.assign(nact, Tracker(stg[0].nmaxout, tracker_last));
+    dts.assign(nact, Tracker(stg[0].nmaxout, tracker_min));
+    hstep = 0.0;
+    tsnap.resize(nact);
+
+    //-----------------------------------------------
+    //diagnostics, with the uniform properties of each lane
+
+    diag.resize(nact);
+    for (w=0; w<nact; w++) {
+        std::vector<double> cw(n, stg[w].c0), rhow(n, stg[w].rho0);
+        diag[w].reset(grid, stg[w], cw.data(), rhow.data());
+    }
+
+    //------
+    //events
+
+    events.resize(nact);
+    reducers.resize(nact);
+
+    //output goes to separate files until an archive is set
+    archive = NULL;
+    writer = NULL;
+    halt.assign(nact, false);
+    nhalt = 0;
+}
+
+void HeatBatch::set_steady (double tin) {
+    for (long w=0; w<NLANE; w++) {
+        T[(n-1)*NLANE + w] = f_Ts(w, tin) + qgeo0[w]*(delz[n-1]/2)/k0[w];
+        for (long i=n-1; i>0; i--)
+            T[(i-1)*NLANE + w] = T[i*NLANE + w] + qgeo0[w]/(k0[w]*gefac[i]);
+    }
+}
+
+double HeatBatch::f_Ts (long w, double tin) {
+    return(
+        Tsa[w] + (Tsb[w] - Tsa[w])*(1.0 - exp(-tin/Tsc[w]))
+    );
+}
+
+//------------------------------------------------------------------------------
+//ODE solver functions
+
+void HeatBatch::ode_fun (const double *Tin, double tin, double *dTdt) {
+
+    long i, w;
+    double g, idz;
+    //flux through the bottom edge of the current cell in each lane
+    double qb[NLANE];
+    //surface temperature of each lane
+    double Tsurf[NLANE];
+
+    for (w=0; w<NLANE; w++) {
+        qb[w] = qgeo0[w];
+        Tsurf[w] = f_Ts(w, tin);
+    }
+
+    //one fused pass computing fluxes and time derivatives, vectorized over lanes
+    for (i=0; i<n; i++) {
+        const double *Ti = Tin + i*NLANE;
+        const double *Tj = i < n-1 ? Ti + NLANE : Tsurf;
+        double *fi = dTdt + i*NLANE;
+        //edge gradient factor, the surface edge is half a cell above the center
+        g = i < n-1 ? gefac[i+1] : 2.0/delz[n-1];
+        idz = 1.0/delz[i];
+        #pragma omp simd
+        for (w=0; w<NLANE; w++) {
+            double qt = -k0[w]*g*(Tj[w] - Ti[w]);
+            double cap = cap0[w] + (fabs(Ti[w] - Tf[w]) <= hw[w] ? LHw[w] : 0.0);
+            fi[w] = ((qb[w] - qt)/cap)*idz;
+            qb[w] = qt;
+        }
+    }
+}
+
+void HeatBatch::step (double dt) {
+
+    long j;
+    long m = n*NLANE;
+    TELEMETRY_COUNT(tel.nstep, 1);
+    TELEMETRY_COUNT(tel.ncell, 2*n*NLANE);
+
+    ode_fun(T.data(), t, k1.data());
+    #pragma omp simd
+    for (j=0; j<m; j++) Tstg[j] = T[j] + dt*k1[j];
+    ode_fun(Tstg.data(), t + dt, k2.data());
+    #pragma omp simd
+    for (j=0; j<m; j++) T[j] += dt*(k1[j] + k2[j])/2.0;
+    t += dt;
+}
+
+void HeatBatch::solve (double tint, unsigned long nsnap, const char *dirout) {
+
+    TELEMETRY_TIME(tel.tsolve);
+    long w;
+    unsigned long isnap;
+    double t0 = t;
+    double ts, h;
+    bool last;
+
+    if ( nsnap < 2 )
+        print_exit("batch solves need at least two snaps, for the initial and final states");
+
+    //common step, limited by the least stable lane
+    double dt = INFINITY;
+    for (w=0; w<nact; w++)
+        if ( dt > stg[0].dtfac*dtmax[w] )
+            dt = stg[0].dtfac*dtmax[w];
+
+    //pick up where a killed run left off, if checkpointing
+    std::string fnck = std::string(dirout) + "/" + names[0] + "_batch_checkpoint";
+    if ( (stg[0].checkpoint > 0) && load_checkpoint(fnck, tint, nsnap, t0, isnap) ) {
+        std::cout << names[0] << ": resuming batch from checkpoint at t = " << t << std::endl;
+    } else {
+        //equilibrium with the boundary conditions, if requested
+        if ( stg[0].steady ) set_steady(t0);
+        write_static(dirout);
+        for (w=0; w<nact; w++) {
+            write_snap(dirout, w, 0, t0);
+            //begin monitoring events and reductions
+            std::vector<double> v;
+            lane_profile(w, v);
+            for (unsigned long j=0; j<events[w].size(); j++)
+                events[w][j].start(t0, lane_quantity(w, events[w][j], t0, max(v.data(), n), min(v.data(), n)));
+            for (unsigned long j=0; j<reducers[w].size(); j++)
+                reducers[w][j].start(t0, lane_quantity(w, reducers[w][j].event, t0, max(v.data(), n), min(v.data(), n)));
+            diag[w].start(t0, lane_qs(w, t0));
+        }
+        isnap = 1;
+    }
+    auto tck = std::chrono::steady_clock::now();
+
+    for (; (isnap<nsnap) && (nhalt < nact); isnap++) {
+        //time of the next snap
+        ts = t0 + tint*double(isnap)/double(nsnap - 1);
+        while ( (t < ts) && (nhalt < nact) ) {
+            //don't step past the snap
+            last = !(dt < ts - t);
+            h = last ? ts - t : dt;
+            step(h);
+            hstep = h;
+            //land exactly on the snap
+            if ( last ) t = ts;
+            track(dirout, isnap, t);
+            //periodic checkpoint
+            if ( (stg[0].checkpoint > 0) && (std::chrono::duration<double>(std::chrono::steady_clock::now() - tck).count() > stg[0].checkpoint) ) {
+                save_checkpoint(fnck, tint, nsnap, t0, isnap);
+                tck = std::chrono::steady_clock::now();
+            }
+        }
+        for (w=0; w<nact; w++)
+            if ( !halt[w] )
+                write_snap(dirout, w, isnap, t);
+    }
+
+    write_trackers(dirout);
+    //the output is complete, so the checkpoint is no longer needed
+    if ( stg[0].checkpoint > 0 ) remove(fnck.c_str());
+}
+
+void HeatBatch::save_checkpoint (std::string fn, double tint, unsigned long nsnap, double t0, unsigned long isnap) {
+
+    long w;
+
+    //everything written so far has to be on disk before the checkpoint is
+    if ( writer != NULL ) writer->flush();
+    if ( archive != NULL ) archive->flush();
+
+    CheckpointWriter ck(fn);
+    //which batch
+    for (w=0; w<nact; w++) ck.put(names[w]);
+    ck.put(n);
+    ck.put(tint);
+    ck.put(long(nsnap));
+    //where it is
+    ck.put(t0);
+    ck.put(long(isnap));
+    ck.put(t);
+    ck.put(T);
+    for (w=0; w<nact; w++) {
+        ck.put(long(halt[w]));
+        ck.put(tsnap[w]);
+        tt[w].save(ck);
+        Tmax[w].save(ck);
+        Tmin[w].save(ck);
+        Ts[w].save(ck);
+        qs[w].save(ck);
+        dts[w].save(ck);
+        diag[w].save(ck);
+        ck.put(long(events[w].size()));
+        for (unsigned long j=0; j<events[w].size(); j++)
+            events[w][j].save(ck);
+        ck.put(long(reducers[w].size()));
+        for (unsigned long j=0; j<reducers[w].size(); j++)
+            reducers[w][j].save(ck);
+    }
+    ck.close();
+}
+
+bool HeatBatch::load_checkpoint (std::string fn, double tint, unsigned long nsnap, double &t0, unsigned long &isnap) {
+
+    long w;
+    CheckpointReader ck(fn);
+    std::string name;
+    //a checkpoint of some other batch is ignored
+    for (w=0; w<nact; w++)
+        if ( !ck.get(name) || (name != names[w]) ) return(false);
+    if ( !ck.expect(n) || !ck.expect(tint) || !ck.expect(long(nsnap)) ) return(false);
+
+    //past this point, the checkpoint is for this batch and must be complete
+    double t0_, tin;
+    long isnap_, halt_ = 0;
+    bool good = ck.get(t0_) && ck.get(isnap_) && ck.get(tin) && ck.get(T.data(), long(T.size()));
+    nhalt = 0;
+    for (w=0; (w<nact) && good; w++) {
+        good = ck.get(halt_) && ck.get(tsnap[w])
+            && tt[w].load(ck) && Tmax[w].load(ck) && Tmin[w].load(ck) && Ts[w].load(ck) && qs[w].load(ck) && dts[w].load(ck) && diag[w].load(ck)
+            && ck.expect(long(events[w].size()));
+        for (unsigned long j=0; (j<events[w].size()) && good; j++)
+            good = events[w][j].load(ck);
+        good = good && ck.expect(long(reducers[w].size()));
+        for (unsigned long j=0; (j<reducers[w].size()) && good; j++)
+            good = reducers[w][j].load(ck);
+        halt[w] = halt_ != 0;
+        if ( halt[w] ) nhalt++;
+    }
+    if ( !good ) print_exit(("checkpoint " + fn + " is damaged or doesn't match the batch, remove it to start over").c_str());
+
+    t0 = t0_;
+    isnap = (unsigned long)isnap_;
+    t = tin;
+    return(true);
+}
+
+//------------------------------------------------------------------------------
+//output
+
+void HeatBatch::lane_profile (long w, std::vector<double> &v) {
+    v.resize(n);
+    for (long i=0; i<n; i++) v[i] = T[i*NLANE + w];
+}
+
+void HeatBatch::lane_fluxes (long w, std::vector<double> &dTdz, std::vector<double> &q) {
+    long i;
+    dTdz.resize(n+1);
+    q.resize(n+1);
+    dTdz[0] = -qgeo0[w]/k0[w];
+    for (i=1; i<n; i++) dTdz[i] = gefac[i]*(T[i*NLANE + w] - T[(i-1)*NLANE + w]);
+    dTdz[n] = (f_Ts(w, t) - T[(n-1)*NLANE + w])/(delz[n-1]/2);
+    for (i=0; i<n+1; i++) q[i] = -dTdz[i]*k0[w];
+}
+
+void HeatBatch::write_static (std::string dirout) {
+    long i, w;
+    double Tw;
+    std::vector<double> v;
+    for (w=0; w<nact; w++) {
+        if ( stg[0].rho )
+            output(dirout, w, "rho", -1, NAN, std::vector<double>(n, stg[w].rho0));
+        if ( stg[0].c )
+            output(dirout, w, "c", -1, NAN, std::vector<double>(n, stg[w].c0));
+        if ( stg[0].k )
+            output(dirout, w, "k", -1, NAN, std::vector<double>(n+1, k0[w]));
+        if ( stg[0].cap ) {
+            v.resize(n);
+            for (i=0; i<n; i++) {
+                Tw = T[i*NLANE + w];
+                v[i] = cap0[w] + (fabs(Tw - Tf[w]) <= hw[w] ? LHw[w] : 0.0);
+            }
+            output(dirout, w, "cap", -1, NAN, v);
+        }
+    }
+}
+
+double HeatBatch::lane_qs (long w, double tin) {
+    return( -k0[w]*(f_Ts(w, tin) - T[(n-1)*NLANE + w])/(delz[n-1]/2) );
+}
+
+double HeatBatch::lane_probe (long w, double depth) {
+    std::vector<double> v;
+    lane_profile(w, v);
+    return( interp(zc.data(), v.data(), -depth, n) );
+}
+
+double HeatBatch::lane_quantity (long w, const Event &e, double tin, double hi, double lo) {
+    switch ( e.kind ) {
+        case event_Tmin:
+            return(lo);
+        case event_Tmax:
+            return(hi);
+        case event_probe:
+            return( lane_probe(w, e.depth) );
+        case event_qs:
+            return( lane_qs(w, tin) );
+    }
+    return(NAN);
+}
+
+void HeatBatch::write_snap (std::string dirout, long w, long isnap, double tin) {
+    std::vector<double> v, dTdz, q;
+    if ( stg[0].T ) {
+        lane_profile(w, v);
+        output(dirout, w, "T", isnap, tin, v);
+    }
+    if ( stg[0].dTdz || stg[0].q ) {
+        lane_fluxes(w, dTdz, q);
+        if ( stg[0].dTdz )
+            output(dirout, w, "dTdz", isnap, tin, dTdz);
+        if ( stg[0].q )
+            output(dirout, w, "q", isnap, tin, q);
+    }
+    if ( stg[0].tsnap )
+        tsnap[w].push_back( tin );
+}
+
+void HeatBatch::track (std::string dirout, long isnap, double tin) {
+
+    long i, w;
+    unsigned long j;
+    double hi[NLANE], lo[NLANE];
+    bool anyevents = false;
+
+    for (w=0; w<nact; w++)
+        if ( !events[w].empty() || !reducers[w].empty() )
+            anyevents = true;
+
+    for (w=0; w<NLANE; w++) hi[w] = lo[w] = T[w];
+    if ( stg[0].Tmax || stg[0].Tmin || anyevents ) {
+        for (i=1; i<n; i++) {
+            const double *Ti = T.data() + i*NLANE;
+            #pragma omp simd
+            for (w=0; w<NLANE; w++) {
+                hi[w] = Ti[w] > hi[w] ? Ti[w] : hi[w];
+                lo[w] = Ti[w] < lo[w] ? Ti[w] : lo[w];
+            }
+        }
+    }
+    for (w=0; w<nact; w++) {
+        if ( halt[w] ) continue;
+        if ( stg[0].Tmax )
+            Tmax[w].push( hi[w] );
+        if ( stg[0].Tmin )
+            Tmin[w].push( lo[w] );
+        if ( stg[0].Ts )
+            Ts[w].push( f_Ts(w, tin) );
+        if ( stg[0].qs )
+            qs[w].push( lane_qs(w, tin) );
+        if ( stg[0].t )
+            tt[w].push( tin );
+        if ( stg[0].dt )
+            dts[w].push( hstep );
+        if ( diag[w].active() )
+            diag[w].update(tin, T.data() + w, NLANE, f_Ts(w, tin), lane_qs(w, tin));
+        for (j=0; j<reducers[w].size(); j++)
+            reducers[w][j].update(tin, lane_quantity(w, reducers[w][j].event, tin, hi[w], lo[w]));
+        //events
+        for (j=0; j<events[w].size(); j++) {
+            Event &e = events[w][j];
+            if ( e.check(tin, lane_quantity(w, e, tin, hi[w], lo[w])) && e.terminal && !halt[w] ) {
+                //stop the lane with a final snap
+                halt[w] = true;
+                nhalt++;
+                write_snap(dirout, w, isnap, tin);
+            }
+        }
+    }
+}
+
+void HeatBatch::write_trackers (std::string dirout) {
+    for (long w=0; w<nact; w++) {
+        if ( stg[0].Tmax )
+            output(dirout, w, "Tmax", -1, NAN, Tmax[w].values());
+        if ( stg[0].Tmin )
+            output(dirout, w, "Tmin", -1, NAN, Tmin[w].values());
+        if ( stg[0].Ts )
+            output(dirout, w, "Ts", -1, NAN, Ts[w].values());
+        if ( stg[0].qs )
+            output(dirout, w, "qs", -1, NAN, qs[w].values());
+        if ( stg[0].t )
+            output(dirout, w, "t", -1, NAN, tt[w].values());
+        if ( stg[0].dt )
+            output(dirout, w, "dt", -1, NAN, dts[w].values());
+        if ( stg[0].tsnap )
+            output(dirout, w, "tsnap", -1, NAN, tsnap[w]);
+        if ( !events[w].empty() ) {
+            std::vector<double> tcross;
+            for (unsigned long j=0; j<events[w].size(); j++)
+                tcross.push_back( events[w][j].tcross );
+            output(dirout, w, "events", -1, NAN, tcross);
+        }
+        diag[w].write([&](const std::string &var, const std::vector<double> &v) { output(dirout, w, var, -1, NAN, v); });
+    }
+}
+
+double HeatBatch::cost_units (double tint) {
+    //all lanes take the smallest stable step
+    double dt = INFINITY;
+    for (long w=0; w<nact; w++)
+        if ( dt > stg[w].dtfac*dtmax[w] ) dt = stg[w].dtfac*dtmax[w];
+    return( 2.0*double(n)*double(NLANE)*ceil(tint/dt) );
+}
+
+void HeatBatch::output (std::string dirout, long w, std::string var, long isnap, double tin, const std::vector<double> &v) {
+    if ( !stg[0].trial_files ) return;
+    TELEMETRY_TIME(tel.twrite);
+    TELEMETRY_COUNT(tel.nbyte, long(v.size()*sizeof(double)));
+    write_output(archive, writer, dirout, names[w], var, isnap, tin, v.data(), long(v.size()));
+}
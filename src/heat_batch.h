@@ -0,0 +1,189 @@
+#ifndef HEAT_BATCH_H_
+#define HEAT_BATCH_H_
+
+//! \file heat_batch.h
+
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "io.h"
+#include "util.h"
+#include "grid.h"
+#include "event.h"
+#include "reducer.h"
+#include "archive.h"
+#include "writer.h"
+#include "tracker.h"
+#include "diagnostics.h"
+#include "telemetry.h"
+#include "settings.h"
+
+#ifndef NLANE
+//!number of trials integrated together by a HeatBatch, one per SIMD lane
+#define NLANE 8
+#endif
+
+//!integrates a batch of independent trials over the same grid, one trial per SIMD lane
+/*!
+Temperatures are stored in structure-of-arrays form, with the NLANE trials of each cell adjacent in memory, so the flux and divergence loops vectorize across trials. All lanes take a common explicit trapezoidal step, the smallest of their stable steps, so batches should be filled with trials that have similar conductivities (and therefore similar stable steps).
+
+Only the physics of the base Heat class is available (uniform properties, exponential surface temperature ramp, constant geothermal flux, apparent heat capacity). The parameters k0, qgeo0, Tsa, Tsb, Tsc, rho0, c0, LH, Tf, and ahcw may differ between lanes. Grid, integration, and output settings are taken from the first lane. Output files have the same names and format as those written by Heat. Events and reductions may be registered, and diagnostics (see Diagnostics) are tracked, for each lane, as in Heat. A lane stops writing output when one of its terminal events is found, with a final snap, and the batch stops when all of its lanes have stopped.
+*/
+class HeatBatch {
+
+public:
+
+    //!constructs
+    /*!
+    \param[in] grid grid shared by all trials
+    \param[in] stgs settings for each trial, between 1 and NLANE of them
+    */
+    HeatBatch (const Grid &grid, std::vector<Settings> stgs);
+
+    //!number of cells
+    const long n;
+    //!number of lanes holding real trials
+    const long nact;
+    //!settings for each active lane
+    std::vector<Settings> stg;
+
+    //!the grid, holding a reference to the arrays viewed below
+    const Grid grid;
+    //!cell center coordinates (m)
+    const GridView zc;
+    //!cell width (m)
+    const GridView delz;
+    //!factors for cell edge gradients
+    const GridView gefac;
+
+    //!maximum stable time step of each lane
+    double dtmax[NLANE];
+
+    //!sets the output name of a lane
+    void set_name (long w, std::string name) { names[w] = name; }
+    //!gets the output name of a lane
+    std::string get_name (long w) { return(names[w]); }
+    //!gets the current time
+    double get_t () { return(t); }
+    //!gets the temperature of one cell in one lane
+    double get_T (long i, long w) { return(T[i*NLANE + w]); }
+    //!performance counters of the whole batch, filled in when compiled with -DTELEMETRY
+    Telemetry tel;
+    //!registers an event for a lane
+    void add_event (long w, Event e) { events[w].push_back(e); }
+    //!registers a reduction for a lane
+    void add_reducer (long w, Reducer r) { reducers[w].push_back(r); }
+    //!registered reductions of each lane, whose results aren't written by HeatBatch (see Sweep)
+    std::vector< std::vector<Reducer> > reducers;
+    //!whether a lane has found a terminal event
+    bool get_halt (long w) { return(halt[w]); }
+    //!diagnostics of each lane, as Heat tracks them, written with the lane's trackers
+    std::vector<Diagnostics> diag;
+    //!sends all output to an archive, which may be shared by many batches, instead of separate files
+    void set_archive (Archive *a) { archive = a; }
+    //!hands all output to a background writer, which may be shared by many batches
+    void set_writer (Writer *w) { writer = w; }
+
+    //!surface temperature of a lane over time (K)
+    double f_Ts (long w, double tin);
+
+    //!sets every lane's temperatures to the steady state of its boundary conditions at a time, as Heat::steady_state does
+    void set_steady (double tin);
+
+    //!computes time derivatives of all lanes
+    void ode_fun (const double *Tin, double tin, double *dTdt);
+    //!takes a single explicit trapezoidal step with all lanes
+    void step (double dt);
+    //!integrates all lanes with their common stable time step
+    /*!
+    With the steady setting, the lanes start from the steady states of their boundary conditions.
+    \param[in] tint duration of the integration
+    \param[in] nsnap number of snapshots, including the initial state
+    \param[in] dirout output directory
+    */
+    void solve (double tint, unsigned long nsnap, const char *dirout);
+    //!writes the state of HeatBatch::solve to a checkpoint file, replacing any earlier one
+    /*!
+    Like Heat, batches are checkpointed every `checkpoint` seconds of wall clock time, to dirout/name_batch_checkpoint where name is the first lane's name, and the checkpoint is removed when the solve finishes.
+    */
+    void save_checkpoint (std::string fn, double tint, unsigned long nsnap, double t0, unsigned long isnap);
+    //!restores the state of HeatBatch::solve from a checkpoint file, returning false if there isn't one for the same batch
+    bool load_checkpoint (std::string fn, double tint, unsigned long nsnap, double &t0, unsigned long &isnap);
+    //!predicts the work of an integration, in cells times right-hand side evaluations of all lanes, for scheduling
+    double cost_units (double tint);
+
+private:
+
+    //!current time
+    double t;
+    //!output names of the lanes
+    std::vector<std::string> names;
+    //!archive receiving all output, or NULL to write a file for each variable
+    Archive *archive;
+    //!background writer taking all output, or NULL to write on the integrating thread
+    Writer *writer;
+
+    //lane parameters
+    double k0[NLANE];
+    double qgeo0[NLANE];
+    double Tsa[NLANE];
+    double Tsb[NLANE];
+    double Tsc[NLANE];
+    double cap0[NLANE];
+    double LHw[NLANE];
+    double Tf[NLANE];
+    double hw[NLANE];
+
+    //!temperatures, cell-major with lanes adjacent
+    std::vector<double> T;
+    //!first stage derivatives
+    std::vector<double> k1;
+    //!second stage derivatives
+    std::vector<double> k2;
+    //!first stage temperatures
+    std::vector<double> Tstg;
+
+    //!registered events of each lane
+    std::vector< std::vector<Event> > events;
+    //!whether each lane has found a terminal event
+    std::vector<bool> halt;
+    //!number of lanes that have found a terminal event
+    long nhalt;
+
+    //trackers for each lane
+    std::vector<Tracker> tt;
+    std::vector<Tracker> Tmax;
+    std::vector<Tracker> Tmin;
+    std::vector<Tracker> Ts;
+    std::vector<Tracker> qs;
+    std::vector<Tracker> dts;
+    std::vector< std::vector<double> > tsnap;
+    //!size of the last step, common to every lane
+    double hstep;
+
+    //!copies one lane's temperature profile into a vector
+    void lane_profile (long w, std::vector<double> &v);
+    //!computes one lane's gradients and fluxes at every cell edge
+    void lane_fluxes (long w, std::vector<double> &dTdz, std::vector<double> &q);
+    //!writes static physical variables
+    void write_static (std::string dirout);
+    //!computes the surface heat flux of one lane (W/m^2)
+    double lane_qs (long w, double tin);
+    //!computes the temperature at a depth in one lane, interpolated between cell centers (K)
+    double lane_probe (long w, double depth);
+    //!computes the quantity monitored by an event in one lane, given the lane's extreme temperatures
+    double lane_quantity (long w, const Event &e, double tin, double hi, double lo);
+    //!writes snapshot profiles of one lane
+    void write_snap (std::string dirout, long w, long isnap, double tin);
+    //!updates trackers and checks events, writing a final snap for lanes that halt
+    void track (std::string dirout, long isnap, double tin);
+    //!writes the trackers
+    void write_trackers (std::string dirout);
+    //!writes one output variable of a lane to the archive or, without one, to a file named as Heat names it, unless the trial_files setting is off
+    void output (std::string dirout, long w, std::string var, long isnap, double tin, const std::vector<double> &v);
+};
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef HEAT_KERNEL_H_
+#define HEAT_KERNEL_H_
+
+//! \file heat_kernel.h
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "grid.h"
+#include "settings.h"
+#include "heat.h"
+
+//------------------------------------------------------------------------------
+//policies for the physics of a HeatKernel
+
+//!exponential ramp of surface temperature from Tsa to Tsb with time scale Tsc, as in Heat::f_Ts
+/*!
+The exponential is only evaluated when the time changes, so repeated requests within a step (ode_fun, trackers) reuse it.
+*/
+class SurfaceRamp {
+public:
+    //!constructs from the settings of a Heat object
+    template<class H> SurfaceRamp (H &h) :
+        Tsa (h.stg.Tsa), Tsb (h.stg.Tsb), Tsc (h.stg.Tsc), tlast (NAN), Tslast (NAN) {}
+    //!surface temperature (K)
+    double Ts (double t, const double *T) {
+        (void)T;
+        if ( t != tlast ) {
+            tlast = t;
+            Tslast = Tsa + (Tsb - Tsa)*(1.0 - exp(-t/Tsc));
+        }
+        return(Tslast);
+    }
+private:
+    double Tsa, Tsb, Tsc;
+    double tlast, Tslast;
+};
+
+//!surface temperature in radiation balance, as in Heat::f_Ts_radiative, for Heat objects with the radiative setting
+/*!
+The Newton iteration warm starts from the Heat object's previous solution, so each evaluation usually takes one or two iterations.
+*/
+class SurfaceRadiative {
+public:
+    //!constructs from a Heat object, whose radiative solve is used
+    template<class H> SurfaceRadiative (H &h) : hl (&h), n (h.n) {}
+    //!surface temperature (K)
+    double Ts (double t, const double *T) {
+        (void)t;
+        return( hl->f_Ts_radiative(T[n-1]) );
+    }
+private:
+    Heat *hl;
+    long n;
+};
+
+//!constant geothermal heat flux qgeo0, as in Heat::f_qgeo
+class BottomFlux {
+public:
+    //!constructs from the settings of a Heat object
+    template<class H> BottomFlux (H &h) : qgeo0 (h.stg.qgeo0) {}
+    //!geothermal heat flux (W/m^2)
+    double qgeo (double t) const { (void)t; return(qgeo0); }
+private:
+    double qgeo0;
+};
+
+//!apparent heat capacity for latent heat, as in Heat::f_cap, but without branches
+class ApparentCapacity {
+public:
+    //!constructs from the settings of a Heat object
+    template<class H> ApparentCapacity (H &h) :
+        Tf (h.stg.Tf), hw (h.stg.ahcw/2.0), LHw (h.stg.LH/h.stg.ahcw) {}
+    //!thermal capacity, given the capacity c*rho without latent heat (J/m^3*K)
+    double cap (double cap0, double T) const {
+        return( cap0 + LHw*double(fabs(T - Tf) <= hw) );
+    }
+private:
+    double Tf, hw, LHw;
+};
+
+//------------------------------------------------------------------------------
+
+//!Heat integrator with its boundary conditions and properties fixed at compile time
+/*!
+The virtual physics functions of Heat (f_Ts, f_qgeo, f_cap) are replaced by calls to the policy classes, which are inlined into a single branchless pass over the cells using precomputed edge conductances k*gefac and inverse cell widths. The policies are constructed from the Heat object after the Base constructor runs, so they may read anything it sets up. Each policy class must provide:
+    - SurfaceBC: `double Ts (double t, const double *T)`
+    - BottomBC: `double qgeo (double t)`
+    - PropertyModel: `double cap (double cap0, double T)`
+
+The Base class defaults to Heat, but may be any subclass of it (such as ImpactLayer), whose constructor arguments are forwarded. The virtual functions of Heat remain available as the slower, more flexible path. Properties from f_k, f_rho, and f_c are read once from the Base object's arrays, so they may still be overridden in Base. The initial temperatures are set by the Base constructor. HeatKernel::reset resets the Base object with its own reset, so a HeatKernel can be reused across trials like a Heat object.
+*/
+template<class SurfaceBC, class BottomBC, class PropertyModel, class Base=Heat>
+class HeatKernel : public Base {
+
+public:
+
+    //!constructs the Base object with any arguments, then the policies
+    template<class... Args>
+    HeatKernel (Args&&... args) :
+        Base (std::forward<Args>(args)...),
+        surf (*this),
+        bot (*this),
+        prop (*this) {
+
+        kg.resize(this->n+1);
+        idelz.resize(this->n);
+        cap0.resize(this->n);
+        precompute();
+    }
+
+    //!resets the Base object with any arguments (see Heat::reset), then the policies and precomputed arrays, without allocating memory
+    template<class... Args>
+    void reset (Args&&... args) {
+        Base::reset(std::forward<Args>(args)...);
+        surf = SurfaceBC(*this);
+        bot = BottomBC(*this);
+        prop = PropertyModel(*this);
+        precompute();
+    }
+
+    //!surface boundary condition
+    SurfaceBC surf;
+    //!bottom boundary condition
+    BottomBC bot;
+    //!thermal capacity model
+    PropertyModel prop;
+
+    //!edge conductances k*gefac, using the half cell width at the surface (W/m^2*K)
+    std::vector<double> kg;
+    //!inverse cell widths (1/m)
+    std::vector<double> idelz;
+    //!thermal capacities without latent heat (J/m^3*K)
+    std::vector<double> cap0;
+
+    //!surface temperature from the SurfaceBC policy
+    double f_Ts (double t, double Tsa, double Tsb, double Tsc) {
+        (void)Tsa; (void)Tsb; (void)Tsc;
+        return( surf.Ts(t, this->get_sol()) );
+    }
+    //!surface temperature of the solver from the SurfaceBC policy, so trackers, events, and snaps agree with ode_fun
+    double surface_temperature (double tin, const double *Tin) {
+        return( surf.Ts(tin, Tin) );
+    }
+    //!geothermal heat flux from the BottomBC policy
+    double f_qgeo (double qgeo0, double t) {
+        (void)qgeo0;
+        return( bot.qgeo(t) );
+    }
+    //!thermal capacity from the PropertyModel policy
+    double f_cap (double c, double rho, double Tin) {
+        return( prop.cap(c*rho, Tin) );
+    }
+
+    //!ode function with every physics call resolved at compile time
+    void ode_fun (double *solin, double *fout) {
+
+        long i;
+        long n = this->n;
+        //alias
+        const double *T = solin;
+        double *dTdt = fout;
+        TELEMETRY_COUNT(this->tel.ncell, n);
+        const double *g = kg.data();
+        const double *dz = idelz.data();
+        const double *c0 = cap0.data();
+        //boundary values
+        double tin = this->get_t();
+        double qgeo = bot.qgeo(tin);
+        double Ts = surf.Ts(tin, T);
+
+        //bottom cell
+        dTdt[0] = (qgeo + g[1]*(T[1] - T[0]))*dz[0]/prop.cap(c0[0], T[0]);
+        //interior cells, with no branches or virtual calls
+        for (i=1; i<n-1; i++)
+            dTdt[i] = (g[i+1]*(T[i+1] - T[i]) - g[i]*(T[i] - T[i-1]))*dz[i]/prop.cap(c0[i], T[i]);
+        //top cell
+        dTdt[n-1] = (g[n]*(Ts - T[n-1]) - g[n-1]*(T[n-1] - T[n-2]))*dz[n-1]/prop.cap(c0[n-1], T[n-1]);
+    }
+
+    //!fills the edge gradients and fluxes, which ode_fun skips, before writing a snap
+    void after_snap (std::string dirout, long isnap, double tin) {
+        this->update_fluxes(this->get_sol(), tin);
+        Base::after_snap(dirout, isnap, tin);
+    }
+
+private:
+
+    //!fills kg, idelz, and cap0 from the Base object's grid and properties
+    void precompute () {
+
+        long i;
+        long n = this->n;
+
+        //edge conductances, with the surface edge half a cell above the top center
+        kg[0] = 0.0;
+        for (i=1; i<n; i++) kg[i] = this->k[i]*this->gefac[i];
+        kg[n] = this->k[n]/(this->delz[n-1]/2);
+        //inverse cell widths and capacities without latent heat
+        for (i=0; i<n; i++) {
+            idelz[i] = 1.0/this->delz[i];
+            cap0[i] = this->c[i]*this->rho[i];
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,311 @@
+//! \file heat_linear.cc
+
+#include "heat_linear.h"
+
+HeatLinear::HeatLinear (const Grid &gridin, std::vector<Settings> stgsin) :
+    Heat   (gridin, response_settings(stgsin)),
+    ntrial (long(stgsin.size())),
+    stgs   (stgsin) {
+
+    long i, w;
+
+    //the response writes no output of its own
+    Heat::set_name("linear");
+
+    //geotherm of a unit flux, as the constructor of Heat sets it up
+    G.resize(n);
+    for (i=0; i<n; i++)
+        G[i] = f_geotherm(0.0, Heat::f_qgeo(1.0, 0), Heat::f_k(stg.k0, 0), -zc[i]);
+
+    //the trials, named by number until named otherwise
+    trials.resize(ntrial);
+    for (w=0; w<ntrial; w++) {
+        LinearTrial &r = trials[w];
+        r.name = int_to_string(w);
+        r.Tsa = stgs[w].Tsa;
+        r.dTs = stgs[w].Tsb - stgs[w].Tsa;
+        r.qgeo = stgs[w].qgeo0;
+        r.halt = false;
+        r.t = Tracker(stg.nmaxout, tracker_last);
+        r.Tmax = Tracker(stg.nmaxout, tracker_max);
+        r.Tmin = Tracker(stg.nmaxout, tracker_min);
+        r.Ts = Tracker(stg.nmaxout, tracker_last);
+        r.qs = Tracker(stg.nmaxout, tracker_last);
+        r.dts = Tracker(stg.nmaxout, tracker_min);
+        r.diag.reset(grid, stgs[w], c.data(), rho.data());
+    }
+    nhalt = 0;
+    extremes = false;
+    isnext = 1;
+}
+
+Settings HeatLinear::response_settings (const std::vector<Settings> &stgs) {
+
+    if ( stgs.empty() )
+        print_exit("a HeatLinear must be constructed with at least one settings");
+    for (unsigned long w=0; w<stgs.size(); w++)
+        if ( !linear(stgs[w]) )
+            print_exit("a HeatLinear can only superpose trials without latent heat, radiative surfaces, or the enthalpy formulation");
+
+    Settings s = stgs[0];
+    //accuracy targets for the largest ramp
+    double dTs = 0.0;
+    for (unsigned long w=0; w<stgs.size(); w++)
+        if ( fabs(stgs[w].Tsb - stgs[w].Tsa) > dTs )
+            dTs = fabs(stgs[w].Tsb - stgs[w].Tsa);
+    if ( dTs > 0 ) {
+        s.dTstep /= dTs;
+        s.atol /= dTs;
+    }
+    //unit ramp from zero temperatures, without geothermal flux
+    s.Tsa = 0.0;
+    s.Tsb = 1.0;
+    s.qgeo0 = 0.0;
+    //the trials' trackers wouldn't be in checkpoints
+    s.checkpoint = 0;
+
+    return(s);
+}
+
+double HeatLinear::trial_Ts (long w, double tin) {
+    return( f_Ts(tin, stgs[w].Tsa, stgs[w].Tsb, stgs[w].Tsc) );
+}
+
+void HeatLinear::trial_profile (long w, std::vector<double> &v) {
+    v.resize(n);
+    for (long i=0; i<n; i++) v[i] = trial_T(w, i);
+}
+
+void HeatLinear::trial_fluxes (long w, double tin, std::vector<double> &dTdz, std::vector<double> &q) {
+    long i;
+    std::vector<double> v;
+    trial_profile(w, v);
+    dTdz.resize(n+1);
+    q.resize(n+1);
+    dTdz[0] = -f_qgeo(trials[w].qgeo, tin)/k[0];
+    for (i=1; i<n; i++) dTdz[i] = gefac[i]*(v[i] - v[i-1]);
+    dTdz[n] = (trial_Ts(w, tin) - v[n-1])/(delz[n-1]/2);
+    for (i=0; i<n+1; i++) q[i] = f_q(dTdz[i], k[i]);
+}
+
+double HeatLinear::cost_units (double tint) {
+    return( Heat::cost_units(tint) + double(ntrial)*double(n)*double(stg.nsnap) );
+}
+
+//------------------------------------------------------------------------------
+//extremes
+
+void HeatLinear::build_hulls () {
+
+    //alias
+    double *R = this->get_sol();
+    long i, m;
+    //turn from cell a to b to c, positive if counterclockwise
+    auto turn = [&](long a, long b, long c) {
+        return( (G[b] - G[a])*(R[c] - R[a]) - (R[b] - R[a])*(G[c] - G[a]) );
+    };
+
+    //G increases with depth, so cells are taken from the surface down
+    lower.clear();
+    upper.clear();
+    for (i=n-1; i>=0; i--) {
+        while ( ((m = long(lower.size())) > 1) && (turn(lower[m-2], lower[m-1], i) <= 0) ) lower.pop_back();
+        lower.push_back(i);
+        while ( ((m = long(upper.size())) > 1) && (turn(upper[m-2], upper[m-1], i) >= 0) ) upper.pop_back();
+        upper.push_back(i);
+    }
+}
+
+long HeatLinear::hull_argmin (double a, double b) {
+
+    //alias
+    double *R = this->get_sol();
+    //along the lower hull, a*G + b*R is convex if b >= 0, and along the upper hull if b < 0
+    std::vector<long> &h = b >= 0 ? lower : upper;
+    long lo = 0, hi = long(h.size()) - 1, mid;
+    //first vertex after which the function doesn't decrease
+    while ( lo < hi ) {
+        mid = (lo + hi)/2;
+        if ( a*(G[h[mid+1]] - G[h[mid]]) + b*(R[h[mid+1]] - R[h[mid]]) < 0 )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return(h[lo]);
+}
+
+//------------------------------------------------------------------------------
+//events and trackers
+
+double HeatLinear::trial_quantity (long w, const Event &e, double tin, double hi, double lo) {
+    switch ( e.kind ) {
+        case event_Tmin:
+            return(lo);
+        case event_Tmax:
+            return(hi);
+        case event_probe:
+            return( trials[w].Tsa + trials[w].qgeo*interp(zc.data(), G.data(), -e.depth, n) + trials[w].dTs*probe(e.depth) );
+        case event_qs:
+            return( surface_flux(trial_Ts(w, tin), trial_T(w, n-1)) );
+    }
+    return(NAN);
+}
+
+void HeatLinear::after_step (double tin) {
+
+    long w;
+    unsigned long j;
+    double hi = NAN, lo = NAN, Tsw;
+
+    if ( extremes ) build_hulls();
+    for (w=0; w<ntrial; w++) {
+        LinearTrial &r = trials[w];
+        if ( r.halt ) continue;
+        if ( extremes ) {
+            hi = trial_T(w, hull_argmin(-r.qgeo, -r.dTs));
+            lo = trial_T(w, hull_argmin(r.qgeo, r.dTs));
+        }
+        if ( stg.Tmax )
+            r.Tmax.push( hi );
+        if ( stg.Tmin )
+            r.Tmin.push( lo );
+        if ( stg.Ts || stg.qs ) {
+            Tsw = trial_Ts(w, tin);
+            if ( stg.Ts )
+                r.Ts.push( Tsw );
+            if ( stg.qs )
+                r.qs.push( surface_flux(Tsw, trial_T(w, n-1)) );
+        }
+        if ( stg.t )
+            r.t.push( tin );
+        if ( stg.dt )
+            r.dts.push( hstep );
+        if ( r.diag.active() ) {
+            trial_profile(w, Tw);
+            Tsw = trial_Ts(w, tin);
+            r.diag.update(tin, Tw.data(), 1, Tsw, surface_flux(Tsw, Tw[n-1]));
+        }
+        for (j=0; j<r.reducers.size(); j++)
+            r.reducers[j].update(tin, trial_quantity(w, r.reducers[j].event, tin, hi, lo));
+        //events
+        for (j=0; j<r.events.size(); j++) {
+            Event &e = r.events[j];
+            if ( e.check(tin, trial_quantity(w, e, tin, hi, lo)) && e.terminal && !r.halt ) {
+                //stop the trial with a final snap
+                r.halt = true;
+                nhalt++;
+                write_snap(dirsnap, w, isnext, tin);
+            }
+        }
+    }
+    //stop when every trial has
+    if ( nhalt == ntrial ) halt = true;
+}
+
+void HeatLinear::after_snap (std::string dirout, long isnap, double tin) {
+
+    long w;
+    unsigned long j;
+    double hi = NAN, lo = NAN;
+
+    dirsnap = dirout;
+    isnext = isnap + 1;
+    if ( isnap == 0 ) {
+        //extremes are only found if something needs them
+        extremes = stg.Tmax || stg.Tmin;
+        for (w=0; w<ntrial; w++) {
+            for (j=0; j<trials[w].events.size(); j++)
+                if ( (trials[w].events[j].kind == event_Tmin) || (trials[w].events[j].kind == event_Tmax) )
+                    extremes = true;
+            for (j=0; j<trials[w].reducers.size(); j++)
+                if ( (trials[w].reducers[j].event.kind == event_Tmin) || (trials[w].reducers[j].event.kind == event_Tmax) )
+                    extremes = true;
+        }
+        //begin monitoring events and reductions
+        if ( extremes ) build_hulls();
+        for (w=0; w<ntrial; w++) {
+            LinearTrial &r = trials[w];
+            r.halt = false;
+            if ( extremes ) {
+                hi = trial_T(w, hull_argmin(-r.qgeo, -r.dTs));
+                lo = trial_T(w, hull_argmin(r.qgeo, r.dTs));
+            }
+            for (j=0; j<r.events.size(); j++)
+                r.events[j].start(tin, trial_quantity(w, r.events[j], tin, hi, lo));
+            for (j=0; j<r.reducers.size(); j++)
+                r.reducers[j].start(tin, trial_quantity(w, r.reducers[j].event, tin, hi, lo));
+            r.diag.start(tin, surface_flux(trial_Ts(w, tin), trial_T(w, n-1)));
+        }
+        nhalt = 0;
+    }
+    for (w=0; w<ntrial; w++)
+        if ( !trials[w].halt )
+            write_snap(dirout, w, isnap, tin);
+}
+
+//------------------------------------------------------------------------------
+//output
+
+void HeatLinear::write_snap (std::string dirout, long w, long isnap, double tin) {
+    std::vector<double> v, dTdzw, qw;
+    if ( stg.T ) {
+        trial_profile(w, v);
+        output(dirout, w, "T", isnap, tin, v);
+    }
+    if ( stg.dTdz || stg.q ) {
+        trial_fluxes(w, tin, dTdzw, qw);
+        if ( stg.dTdz )
+            output(dirout, w, "dTdz", isnap, tin, dTdzw);
+        if ( stg.q )
+            output(dirout, w, "q", isnap, tin, qw);
+    }
+    if ( stg.tsnap )
+        trials[w].tsnap.push_back( tin );
+}
+
+void HeatLinear::write_static (std::string dirout) {
+    for (long w=0; w<ntrial; w++) {
+        if ( stg.rho )
+            output(dirout, w, "rho", -1, NAN, rho);
+        if ( stg.c )
+            output(dirout, w, "c", -1, NAN, c);
+        if ( stg.k )
+            output(dirout, w, "k", -1, NAN, k);
+        if ( stg.cap )
+            output(dirout, w, "cap", -1, NAN, cap);
+    }
+}
+
+void HeatLinear::write_trackers (std::string dirout) {
+    for (long w=0; w<ntrial; w++) {
+        LinearTrial &r = trials[w];
+        if ( stg.Tmax )
+            output(dirout, w, "Tmax", -1, NAN, r.Tmax.values());
+        if ( stg.Tmin )
+            output(dirout, w, "Tmin", -1, NAN, r.Tmin.values());
+        if ( stg.Ts )
+            output(dirout, w, "Ts", -1, NAN, r.Ts.values());
+        if ( stg.qs )
+            output(dirout, w, "qs", -1, NAN, r.qs.values());
+        if ( stg.t )
+            output(dirout, w, "t", -1, NAN, r.t.values());
+        if ( stg.dt )
+            output(dirout, w, "dt", -1, NAN, r.dts.values());
+        if ( stg.tsnap )
+            output(dirout, w, "tsnap", -1, NAN, r.tsnap);
+        if ( !r.events.empty() ) {
+            std::vector<double> tcross;
+            for (unsigned long j=0; j<r.events.size(); j++)
+                tcross.push_back( r.events[j].tcross );
+            output(dirout, w, "events", -1, NAN, tcross);
+        }
+        r.diag.write([&](const std::string &var, const std::vector<double> &v) { output(dirout, w, var, -1, NAN, v); });
+    }
+}
+
+void HeatLinear::output (std::string dirout, long w, std::string var, long isnap, double tin, const std::vector<double> &v) {
+    if ( !stg.trial_files ) return;
+    TELEMETRY_TIME(tel.twrite);
+    TELEMETRY_COUNT(tel.nbyte, long(v.size()*sizeof(double)));
+    write_output(archive, writer, dirout, trials[w].name, var, isnap, tin, v.data(), long(v.size()));
+}
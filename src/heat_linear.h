@@ -0,0 +1,151 @@
+#ifndef HEAT_LINEAR_H_
+#define HEAT_LINEAR_H_
+
+//! \file heat_linear.h
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "io.h"
+#include "util.h"
+#include "grid.h"
+#include "heat.h"
+#include "event.h"
+#include "reducer.h"
+#include "writer.h"
+#include "tracker.h"
+#include "diagnostics.h"
+#include "settings.h"
+
+//!a trial of a HeatLinear, with the output that's synthesized for it
+struct LinearTrial {
+    //!output name
+    std::string name;
+    //!surface temperature before the ramp (K)
+    double Tsa;
+    //!size of the surface temperature ramp, Tsb - Tsa (K)
+    double dTs;
+    //!geothermal heat flux (W/m^2)
+    double qgeo;
+    //!registered events
+    std::vector<Event> events;
+    //!registered reductions, whose results aren't written by HeatLinear (see Sweep)
+    std::vector<Reducer> reducers;
+    //!whether a terminal event has been found
+    bool halt;
+    //!time tracker
+    Tracker t;
+    //!maximum temperature tracker
+    Tracker Tmax;
+    //!minimum temperature tracker
+    Tracker Tmin;
+    //!surface temperature tracker
+    Tracker Ts;
+    //!surface heat flux tracker
+    Tracker qs;
+    //!step size tracker
+    Tracker dts;
+    //!snapshot times
+    std::vector<double> tsnap;
+    //!diagnostics
+    Diagnostics diag;
+};
+
+//!integrates trials that differ only in Tsa, Tsb, and qgeo0 by superposing one integrated response, when the problem is linear
+/*!
+Without latent heat (LH = 0), with the base physics of Heat and a prescribed surface temperature, the heat equation is linear in the temperatures and both boundary conditions. Every trial starts on the geotherm of its Tsa and qgeo0, which is a steady state, so its temperatures are
+    T = Tsa + qgeo0*G + (Tsb - Tsa)*R
+where G = -zc/k0 is the geotherm of a unit geothermal flux under a zero surface temperature, which doesn't change, and R is the response to the unit surface ramp 1 - exp(-t/Tsc) from zero temperatures without geothermal flux. Only R is integrated, by the Heat object this class extends, with Heat::solve and any of its solvers. The trials' trackers, events, reductions, and snaps are synthesized after every step and snap, with output named by trial, in the same files Heat writes. A trial stops writing output when one of its terminal events is found, with a final snap, and the integration stops when all of the trials have stopped.
+
+The trials must share every setting except Tsa, Tsb, and qgeo0, and output settings are taken from the first one. The accuracy targets of the response (dTstep and atol) are divided by the largest ramp |Tsb - Tsa| of the trials, so that every trial meets them. With explicit steps, each trial matches its own Heat integration to rounding.
+
+The extreme temperatures of a trial are the extremes of a linear function over the points (G, R) of the cells, which are found on the convex hull of the points. The hull is built once per step, in one pass over the cells, since G is ordered by depth, and each trial's extremes are found on it by bisection. So each step costs one step of the response, plus a few operations for each trial, and every trial's Tmin and Tmax trackers, events, and reductions are still exact. Snaps cost a pass over the cells for each trial, and so do diagnostics (see Diagnostics) after every step, since they're computed from each trial's profile. Checkpoints aren't written.
+*/
+class HeatLinear : public Heat {
+
+public:
+
+    //!constructs
+    /*!
+    \param[in] grid grid shared by all trials
+    \param[in] stgs settings of each trial, differing at most in Tsa, Tsb, and qgeo0
+    */
+    HeatLinear (const Grid &grid, std::vector<Settings> stgs);
+
+    //!whether the problem of a settings is linear, so that trials differing in Tsa, Tsb, and qgeo0 can be superposed
+    static bool linear (const Settings &s) { return( (s.LH == 0) && !s.radiative && !s.enthalpy ); }
+
+    //!number of trials
+    const long ntrial;
+    //!settings of each trial
+    std::vector<Settings> stgs;
+    //!the trials
+    std::vector<LinearTrial> trials;
+    //!temperatures of a unit geothermal flux under a zero surface temperature (K per W/m^2)
+    std::vector<double> G;
+
+    //!sets the output name of a trial
+    void set_name (long w, std::string name) { trials[w].name = name; }
+    //!gets the output name of a trial
+    std::string get_name (long w) { return(trials[w].name); }
+    //!registers an event for a trial
+    void add_event (long w, Event e) { trials[w].events.push_back(e); }
+    //!registers a reduction for a trial
+    void add_reducer (long w, Reducer r) { trials[w].reducers.push_back(r); }
+    //!whether a trial has found a terminal event
+    bool get_halt (long w) { return(trials[w].halt); }
+
+    //!surface temperature of a trial over time (K)
+    double trial_Ts (long w, double tin);
+    //!temperature of one cell of a trial at the current time (K)
+    double trial_T (long w, long i) { return( trials[w].Tsa + trials[w].qgeo*G[i] + trials[w].dTs*this->get_sol()[i] ); }
+    //!copies a trial's temperature profile into a vector
+    void trial_profile (long w, std::vector<double> &v);
+
+    //!predicts the work of an integration, the response's work and a pass over the cells for each snap of each trial, for scheduling
+    double cost_units (double tint);
+
+    //!tracks every trial and checks their events after a step of the response
+    void after_step (double tin);
+    //!writes a snap of every trial that hasn't stopped, starting their events at the first snap
+    void after_snap (std::string dirout, long isnap, double tin);
+    //!writes static physical variables of every trial
+    void write_static (std::string dirout);
+    //!writes the trackers of every trial
+    void write_trackers (std::string dirout);
+
+private:
+
+    //!number of trials that have found a terminal event
+    long nhalt;
+    //!whether extreme temperatures are needed, by trackers, events, or reductions
+    bool extremes;
+    //!output directory of the integration in progress
+    std::string dirsnap;
+    //!number of the next snap
+    long isnext;
+    //!cells on the lower convex hull of the points (G, R), in order of increasing G
+    std::vector<long> lower;
+    //!cells on the upper convex hull of the points (G, R), in order of increasing G
+    std::vector<long> upper;
+    //!temperatures of one trial
+    std::vector<double> Tw;
+
+    //!settings of the response, from the first trial with a unit surface ramp, no geothermal flux, and scaled accuracy targets
+    static Settings response_settings (const std::vector<Settings> &stgs);
+    //!builds the convex hulls of the points (G, R)
+    void build_hulls ();
+    //!finds the cell minimizing a*G + b*R, on one of the convex hulls
+    long hull_argmin (double a, double b);
+    //!computes one trial's gradients and fluxes at every cell edge
+    void trial_fluxes (long w, double tin, std::vector<double> &dTdz, std::vector<double> &q);
+    //!computes the quantity monitored by an event in one trial, given the trial's extreme temperatures
+    double trial_quantity (long w, const Event &e, double tin, double hi, double lo);
+    //!writes snapshot profiles of one trial
+    void write_snap (std::string dirout, long w, long isnap, double tin);
+    //!writes one output variable of a trial to the archive or, without one, to a file named as Heat names it, unless the trial_files setting is off
+    void output (std::string dirout, long w, std::string var, long isnap, double tin, const std::vector<double> &v);
+};
+
+#endif
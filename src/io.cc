@@ -56,23 +56,26 @@ void check_file_write (const char *fn) {
     fclose(ofile);
 }
 
-void write_double (const char *fn, double *a, long size) {
+void write_double (const char *fn, const double *a, long size) {
     FILE* ofile;
-    check_file_write(fn);
     ofile = fopen(fn, "wb");
+    if (ofile == NULL) {
+        std::cout << "FAILURE: cannot open file " << fn << std::endl;
+        exit(EXIT_FAILURE);
+    }
     fwrite(a, sizeof(double), size, ofile);
     fclose(ofile);
 }
 
-void write_double (const std::string &fn, double *a, long size) {
+void write_double (const std::string &fn, const double *a, long size) {
     write_double(fn.c_str(), a, size);
 }
 
-void write_double (const char *fn, std::vector<double> a) {
+void write_double (const char *fn, const std::vector<double> &a) {
     write_double(fn, a.data(), long(a.size()));
 }
 
-void write_double (const std::string &fn, std::vector<double> a) {
+void write_double (const std::string &fn, const std::vector<double> &a) {
     write_double(fn.c_str(), a.data(), long(a.size()));
 }
 
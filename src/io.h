@@ -46,7 +46,7 @@ void check_file_write (const char *fn);
 \param[in] a array of numbers to write
 \param[in] size length of array
 */
-void write_double (const char *fn, double *a, long size);
+void write_double (const char *fn, const double *a, long size);
 
 //!writes an array of doubles to a binary file
 /*!
@@ -54,21 +54,21 @@ void write_double (const char *fn, double *a, long size);
 \param[in] a array of numbers to write
 \param[in] size length of array
 */
-void write_double (const std::string &fn, double *a, long size);
+void write_double (const std::string &fn, const double *a, long size);
 
 //!writes an array of doubles to a binary file
 /*!
 \param[in] fn target file path
 \param[in] a vector of numbers to write
 */
-void write_double (const char *fn, std::vector<double> a);
+void write_double (const char *fn, const std::vector<double> &a);
 
 //!writes an array of doubles to a binary file
 /*!
 \param[in] fn target file path
 \param[in] a vector of numbers to write
 */
-void write_double (const std::string &fn, std::vector<double> a);
+void write_double (const std::string &fn, const std::vector<double> &a);
 
 //------------------------------------------------------------------------------
 //reading
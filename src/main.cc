@@ -21,17 +21,36 @@ int main (int argc, char **argv) {
     //read settings
     Settings stg = parse_settings(read_values(argv[1]));
 
+    //open a single output file, if requested
+    Archive *archive = NULL;
+    //(appending when checkpointing, so a restarted run keeps earlier output)
+    if ( stg.archive )
+        archive = new Archive(dirout + "/archive", stg.checkpoint > 0);
+    //write output on a background thread, if requested
+    Writer *writer = NULL;
+    if ( stg.async_write )
+        writer = new Writer(stg.nqueue);
+
     //create grid
     Grid grid(stg.depth, stg.delz0, stg.delzfrac, stg.delzmax);
-    if ( stg.save_grid )
-        grid.save(dirout);
+    if ( stg.save_grid ) {
+        if ( archive ) grid.save(*archive);
+        else grid.save(dirout);
+    }
 
     //create solver
     Heat heat(grid, stg);
+    heat.set_archive(archive);
+    heat.set_writer(writer);
 
     //integrate
     double tint = stg.tint*stg.tunit;
-    heat.solve_adaptive(tint, 1e-12*tint, stg.nsnap, dirout.c_str());
+    heat.solve(tint, stg.nsnap, dirout.c_str());
+
+    //finish writing, then write the archive index
+    if ( writer ) writer->print_counters();
+    delete writer;
+    delete archive;
 
     return(0);
 }
@@ -0,0 +1,353 @@
+//! \file main_bench.cc
+
+#include <map>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <functional>
+
+#include "io.h"
+#include "util.h"
+#include "grid.h"
+#include "heat.h"
+#include "sweep.h"
+#include "series.h"
+#include "settings.h"
+#include "scheduler.h"
+
+//!fraction of a baseline rate that a result may fall below before it's flagged
+#define BENCH_TOLERANCE 0.2
+//!minimum duration of one timed repetition of a microbenchmark (s)
+#define BENCH_MINTIME 0.2
+//!number of timed repetitions of a microbenchmark, of which the median is kept
+#define BENCH_NREP 5
+//!number of repetitions of a macrobenchmark, of which the median is kept
+#define BENCH_NMACRO 3
+
+//!keeps the compiler from discarding benchmarked results
+static volatile double sink;
+
+//!seconds elapsed since a time point
+static double seconds_since (std::chrono::steady_clock::time_point t0) {
+    return( std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() );
+}
+
+//!median of some numbers
+static double median (std::vector<double> x) {
+    std::sort(x.begin(), x.end());
+    long m = long(x.size());
+    return( (m % 2) ? x[m/2] : (x[m/2 - 1] + x[m/2])/2 );
+}
+
+//!times a microbenchmark, returning the median rate over several repetitions
+/*!
+\param[in] body runs one batch of work, returning the amount of work done
+\return work per second
+*/
+static double measure (std::function<double()> body) {
+    std::vector<double> rate(BENCH_NREP);
+    //once to warm up
+    body();
+    for (int rep=0; rep<BENCH_NREP; rep++) {
+        double work = 0.0;
+        auto t0 = std::chrono::steady_clock::now();
+        do work += body(); while ( seconds_since(t0) < BENCH_MINTIME );
+        rate[rep] = work/seconds_since(t0);
+    }
+    return( median(rate) );
+}
+
+//!runs a macrobenchmark several times, returning the median of each of the rates it reports
+static std::vector<double> repeat (std::function<std::vector<double>()> body) {
+    std::vector< std::vector<double> > rates(BENCH_NMACRO);
+    for (int rep=0; rep<BENCH_NMACRO; rep++) rates[rep] = body();
+    std::vector<double> med(rates[0].size());
+    for (unsigned long j=0; j<med.size(); j++) {
+        std::vector<double> x(BENCH_NMACRO);
+        for (int rep=0; rep<BENCH_NMACRO; rep++) x[rep] = rates[rep][j];
+        med[j] = median(x);
+    }
+    return(med);
+}
+
+//!reads the numbers in a flat json object, like the results written by write_results, skipping anything else
+static std::map<std::string,double> read_results (const std::string &fn) {
+    std::map<std::string,double> res;
+    std::ifstream in(fn);
+    if ( !in.good() ) return(res);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string s = ss.str();
+    size_t i = 0, j, k;
+    while ( (i = s.find('"', i)) != std::string::npos ) {
+        j = s.find('"', i + 1);
+        k = s.find(':', j);
+        if ( (j == std::string::npos) || (k == std::string::npos) ) break;
+        std::string key = s.substr(i + 1, j - i - 1);
+        char *end;
+        const char *num = s.c_str() + k + 1;
+        double x = strtod(num, &end);
+        if ( end != num ) res[key] = x;
+        //move past the value
+        i = s.find_first_of(",}", k);
+        if ( i == std::string::npos ) break;
+    }
+    return(res);
+}
+
+//!writes results as a flat json object
+static void write_results (const std::string &fn, const std::vector<std::string> &keys, std::map<std::string,double> &res) {
+    check_file_write(fn.c_str());
+    FILE *ofile = fopen(fn.c_str(), "w");
+    fprintf(ofile, "{\n    \"tolerance\": %g", BENCH_TOLERANCE);
+    for (unsigned long j=0; j<keys.size(); j++)
+        fprintf(ofile, ",\n    \"%s\": %.4e", keys[j].c_str(), res[keys[j]]);
+    fprintf(ofile, "\n}\n");
+    fclose(ofile);
+}
+
+//!benchmark driver
+int main (int argc, char **argv) {
+
+    if ( (argc != 3) && !((argc == 4) && (std::string(argv[3]) == "--save")) )
+        print_exit("crustal_heat_bench must be given two command line arguments\n  1. path to the benchmark directory, with the benchmark settings files and baseline.json\n  2. path to an output directory, with settings, thaw-times, and hot-layer subdirectories\nand optionally --save, to replace the baseline with the new results");
+
+    //store directories
+    std::string dirbench = argv[1];
+    std::string dirout = argv[2];
+    bool save = argc == 4;
+
+    //results, in the order they're reported
+    std::vector<std::string> keys;
+    std::map<std::string,double> res;
+    //results that are reported but never flagged, because they measure the machine more than the code
+    std::vector<std::string> ungated;
+    auto report = [&](std::string key, double x, bool gated=true) {
+        keys.push_back(key);
+        res[key] = x;
+        if ( !gated ) ungated.push_back(key);
+        printf("  %-42s %12.4e\n", key.c_str(), x);
+    };
+
+    //--------------------------------------------------------------------------
+    //microbenchmarks, on the grid of the repository settings
+
+    printf("microbenchmarks\n");
+    Settings stg = parse_settings(read_values((dirbench + "/settings.txt").c_str()));
+    Grid grid(stg.depth, stg.delz0, stg.delzfrac, stg.delzmax);
+    Heat heat(grid, stg);
+    long n = heat.n;
+    std::vector<double> f(n);
+
+    //right-hand side
+    report("ode_fun cell-updates/s", measure([&]() {
+        heat.ode_fun(heat.get_sol(), f.data());
+        return( double(n) );
+    }));
+
+    //capacity, across the freezing point where latent heat is added
+    std::vector<double> Tcap(n);
+    for (long i=0; i<n; i++) Tcap[i] = stg.Tf - 2*stg.ahcw + 4*stg.ahcw*double(i)/double(n);
+    report("f_cap calls/s", measure([&]() {
+        double s = 0.0;
+        for (long i=0; i<n; i++) s += heat.f_cap(heat.c[i], heat.rho[i], Tcap[i]);
+        sink = s;
+        return( double(n) );
+    }));
+
+    //grid construction
+    report("Grid constructions/s", measure([&]() {
+        Grid g(stg.depth, stg.delz0, stg.delzfrac, stg.delzmax);
+        sink = g.get_n();
+        return( 1.0 );
+    }));
+
+    //writing a temperature profile, which mostly times the filesystem
+    std::string fnw = dirout + "/write_double";
+    report("write_double MB/s", measure([&]() {
+        write_double(fnw, heat.get_sol(), n);
+        return( double(n)*sizeof(double)/1e6 );
+    }), false);
+    remove(fnw.c_str());
+
+    //interpolating a time series as long as a year of daily values
+    long nx = 365;
+    std::vector<double> x = linspace(0, 1, nx), y(nx);
+    for (long i=0; i<nx; i++) y[i] = sin(10*x[i]);
+    report("interp calls/s", measure([&]() {
+        double s = 0.0;
+        for (long i=0; i<1000; i++) s += interp(x.data(), y.data(), double(i)/1000.0, nx);
+        sink = s;
+        return( 1000.0 );
+    }));
+
+    //the same, through a shared series and its cursor
+    write_double(dirout + "/series_x", x);
+    write_double(dirout + "/series_y", y);
+    {
+        SeriesCursor cur(Series::open(dirout + "/series_x", dirout + "/series_y"));
+        report("SeriesCursor calls/s", measure([&]() {
+            double s = 0.0;
+            for (long i=0; i<1000; i++) s += cur(double(i)/1000.0);
+            sink = s;
+            return( 1000.0 );
+        }));
+    }
+    remove((dirout + "/series_x").c_str());
+    remove((dirout + "/series_y").c_str());
+
+    //--------------------------------------------------------------------------
+    //macrobenchmarks, reduced versions of real runs
+
+    printf("macrobenchmarks\n");
+
+    //the repository settings
+    {
+        std::vector<double> r = repeat([&]() {
+            Heat h(grid, stg);
+            h.set_quiet(true);
+            auto t0 = std::chrono::steady_clock::now();
+            h.solve(stg.tint*stg.tunit, stg.nsnap, (dirout + "/settings").c_str());
+            double dt = seconds_since(t0);
+            return( std::vector<double>{double(h.get_nstep())/dt, double(h.get_nstep())*double(h.n)/dt} );
+        });
+        report("settings.txt steps/s", r[0]);
+        report("settings.txt cell-updates/s", r[1]);
+    }
+
+    //the same with multirate steps, counting steps of the fastest level so the rate compares with the one above
+    {
+        Settings stgm = stg;
+        stgm.nlevel = 8;
+        std::vector<double> r = repeat([&]() {
+            Heat h(grid, stgm);
+            h.set_quiet(true);
+            auto t0 = std::chrono::steady_clock::now();
+            h.solve(stgm.tint*stgm.tunit, stgm.nsnap, (dirout + "/settings").c_str());
+            return( std::vector<double>{double(h.get_nstep())*double(1L << (h.lcell.size() - 1))/seconds_since(t0)} );
+        });
+        report("settings.txt multirate steps/s", r[0]);
+    }
+
+    //the thaw-times sweep, stopping trials when the column thaws
+    {
+        std::vector<double> r = repeat([&]() {
+            Sweep sweep(read_values((dirbench + "/thaw-times.txt").c_str()));
+            auto t0 = std::chrono::steady_clock::now();
+            sweep.run(dirout + "/thaw-times", NULL, NULL,
+                [](Heat &h, long long i) {
+                    (void)i;
+                    h.add_event(Event(event_Tmin, h.stg.Tf, 1, true));
+                },
+                [](HeatBatch &batch, long w, long long i) {
+                    (void)i;
+                    batch.add_event(w, Event(event_Tmin, batch.stg[w].Tf, 1, true));
+                }
+            );
+            return( std::vector<double>{double(sweep.get_ntrial())/seconds_since(t0)} );
+        });
+        report("thaw-times trials/s", r[0]);
+    }
+
+    //the same without latent heat, where trials differing in Tsa, Tsb, and qgeo0 are superposed
+    {
+        std::vector< std::vector<std::string> > sv = read_values((dirbench + "/thaw-times.txt").c_str());
+        for (unsigned long j=0; j<sv.size(); j++)
+            if ( sv[j][0] == "LH" ) sv[j][1] = "0";
+        std::vector<double> r = repeat([&]() {
+            Sweep sweep(sv);
+            auto t0 = std::chrono::steady_clock::now();
+            sweep.run(dirout + "/thaw-times", NULL, NULL, NULL, NULL,
+                [](HeatLinear &lin, long w, long long i) {
+                    (void)i;
+                    lin.add_event(w, Event(event_Tmin, lin.stgs[w].Tf, 1, true));
+                }
+            );
+            return( std::vector<double>{double(sweep.get_ntrial())/seconds_since(t0)} );
+        });
+        report("thaw-times linear trials/s", r[0]);
+    }
+
+    //a hot layer cooling over a geotherm under a constant surface temperature, set up like the impact-layer project's
+    //trials with a grid for each, but with plain Heat instead of its radiative or series surfaces
+    {
+        std::vector<double> r = repeat([&]() {
+            Sweep sweep(read_values((dirbench + "/hot-layer.txt").c_str()), {"deplayer", "Tlayer", "Tbelow", "depfac", "timfac", "ncell"});
+            long ntrial = long(sweep.get_ntrial());
+            std::vector<double> nup(ntrial, 0.0);
+            Scheduler sched(ntrial);
+            auto t0 = std::chrono::steady_clock::now();
+            sched.run([&](long i) {
+                double deplayer = sweep.param(i, "deplayer");
+                Settings stgi = sweep.trial(i);
+                Grid g(sweep.param(i, "depfac")*deplayer, deplayer/sweep.param(i, "ncell"), 1, 1e9);
+                Heat h(g, stgi);
+                h.set_quiet(true);
+                h.set_name(int_to_string(i));
+                for (long j=0; j<h.n; j++) {
+                    double z = -h.zc[j];
+                    if ( z < deplayer )
+                        h.set_sol(j, sweep.param(i, "Tlayer"));
+                    else
+                        h.set_sol(j, h.f_geotherm(sweep.param(i, "Tbelow"), h.f_qgeo(stgi.qgeo0, 0), h.f_k(stgi.k0, z - deplayer), z - deplayer));
+                }
+                double tint = sweep.param(i, "timfac")*(deplayer*deplayer)/(h.k[0]/h.cap[0]);
+                h.solve(tint, stgi.nsnap, (dirout + "/hot-layer").c_str());
+                nup[i] = double(h.get_nstep())*double(h.n);
+            });
+            double dt = seconds_since(t0);
+            double s = 0.0;
+            for (long i=0; i<ntrial; i++) s += nup[i];
+            return( std::vector<double>{double(ntrial)/dt, s/dt} );
+        });
+        report("hot-layer trials/s", r[0]);
+        report("hot-layer cell-updates/s", r[1]);
+    }
+
+    //--------------------------------------------------------------------------
+    //comparison with the baseline
+
+    std::string fnbase = dirbench + "/baseline.json";
+    write_results(dirout + "/bench.json", keys, res);
+    if ( save ) {
+        write_results(fnbase, keys, res);
+        printf("baseline written to: %s\n", fnbase.c_str());
+        return(0);
+    }
+
+    std::map<std::string,double> base = read_results(fnbase);
+    if ( base.empty() ) {
+        printf("no baseline found at %s, run with --save to make one\n", fnbase.c_str());
+        return(0);
+    }
+    double tol = base.count("tolerance") ? base["tolerance"] : BENCH_TOLERANCE;
+    printf("comparison with %s (flagging rates more than %g %% below it)\n", fnbase.c_str(), 100*tol);
+    long nreg = 0;
+    for (unsigned long j=0; j<keys.size(); j++) {
+        if ( base.count(keys[j]) == 0 ) {
+            printf("  %-42s   (not in baseline)\n", keys[j].c_str());
+            continue;
+        }
+        double r = res[keys[j]]/base[keys[j]];
+        if ( std::find(ungated.begin(), ungated.end(), keys[j]) != ungated.end() ) {
+            printf("  %-42s %8.3f x   (not flagged)\n", keys[j].c_str(), r);
+            continue;
+        }
+        bool reg = r < 1.0 - tol;
+        if ( reg ) nreg++;
+        printf("  %-42s %8.3f x%s\n", keys[j].c_str(), r, reg ? "   REGRESSION" : "");
+    }
+    if ( nreg > 0 ) {
+        printf("%li regressions\n", nreg);
+        return(1);
+    }
+    printf("no regressions\n");
+
+    return(0);
+}
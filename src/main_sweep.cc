@@ -0,0 +1,49 @@
+//! \file main_sweep.cc
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "io.h"
+#include "sweep.h"
+#include "writer.h"
+#include "archive.h"
+#include "settings.h"
+
+//!parameter sweep driver
+int main (int argc, char **argv) {
+
+    if ( argc != 3 )
+        print_exit("crustal_heat_sweep must be given two command line arguments\n  1. path to settings file, with lin(), log(), or list() values for swept settings\n  2. path to output directory");
+
+    //store output directory
+    std::string dirout = argv[2];
+
+    //read settings and expand sweeps
+    Sweep sweep(read_values(argv[1]));
+    Settings &stg = sweep.base;
+
+    //open a single output file shared by all trials, if requested
+    Archive *archive = NULL;
+    //(appending when checkpointing, so a restarted run keeps earlier output)
+    if ( stg.archive )
+        archive = new Archive(dirout + "/archive", stg.checkpoint > 0);
+    //write output on a background thread shared by all trials, if requested
+    Writer *writer = NULL;
+    if ( stg.async_write )
+        writer = new Writer(stg.nqueue);
+
+    //write the table of trials
+    sweep.write_table(dirout + "/trials.csv");
+    printf("trial table written to: %s/trials.csv\n", dirout.c_str());
+
+    //integrate
+    sweep.run(dirout, archive, writer);
+
+    //finish writing, then write the archive index
+    if ( writer ) writer->print_counters();
+    delete writer;
+    delete archive;
+
+    return(0);
+}
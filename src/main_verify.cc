@@ -0,0 +1,232 @@
+//! \file main_verify.cc
+
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "io.h"
+#include "grid.h"
+#include "heat.h"
+#include "sweep.h"
+#include "reducer.h"
+#include "settings.h"
+
+//!number of failed checks
+static long nfail = 0;
+
+//!reports a check, counting it as failed if the error exceeds the tolerance
+static void check (std::string name, double err, double tol) {
+    bool pass = err <= tol;
+    if ( !pass ) nfail++;
+    printf("  %-48s %10.3e  (tolerance %g)%s\n", name.c_str(), err, tol, pass ? "" : "   FAILED");
+}
+
+//!largest absolute difference between two vectors of the same length
+static double maxdiff (const std::vector<double> &a, const std::vector<double> &b) {
+    double d = 0.0;
+    for (unsigned long i=0; i<a.size(); i++)
+        if ( !(fabs(a[i] - b[i]) <= d) ) d = fabs(a[i] - b[i]);
+    return(d);
+}
+
+//!settings of the verification problem: a stretched grid under a warming surface, without latent heat
+static std::vector< std::vector<std::string> > problem () {
+    std::vector< std::vector<std::string> > sv = {
+        {"depth", "50"}, {"delz0", "0.1"}, {"delzfrac", "1.1"}, {"delzmax", "5"},
+        {"tint", "1"}, {"tunit", "31557600"}, {"nsnap", "2"}, {"nmaxout", "100"},
+        {"rho0", "2000"}, {"c0", "1000"}, {"k0", "2"}, {"qgeo0", "0.05"},
+        {"Tsa", "250"}, {"Tsb", "290"}, {"Tsc", "1e6"}, {"LH", "0"}, {"Tf", "273"}, {"ahcw", "1"}
+    };
+    return(sv);
+}
+
+//!integrates the verification problem with Heat::solve, returning the final temperatures
+static std::vector<double> final_temperatures (Settings stg, std::string name, std::string dirout) {
+    Grid grid(stg.depth, stg.delz0, stg.delzfrac, stg.delzmax);
+    Heat heat(grid, stg);
+    heat.set_quiet(true);
+    heat.set_name(name);
+    heat.solve(stg.tint*stg.tunit, stg.nsnap, dirout.c_str());
+    return( std::vector<double>(heat.get_sol(), heat.get_sol() + heat.n) );
+}
+
+//!Heat with a sinusoidal surface temperature between Tsa and Tsb and a period of Tsc
+class PeriodicHeat : public Heat {
+public:
+    PeriodicHeat (Grid &grid, Settings &stg) : Heat(grid, stg) {}
+    double f_Ts (double t, double Tsa, double Tsb, double Tsc) {
+        return( (Tsa + Tsb)/2 + (Tsb - Tsa)/2*sin(2*M_PI*t/Tsc) );
+    }
+};
+
+//!Heat that's killed, as a run would be, when its surface temperature is first needed past a time
+class KilledHeat : public Heat {
+public:
+    KilledHeat (Grid &grid, Settings &stg, double tkill_) : Heat(grid, stg) { tkill = tkill_; }
+    double f_Ts (double t, double Tsa, double Tsb, double Tsc) {
+        if ( t > tkill ) raise(SIGKILL);
+        return( Heat::f_Ts(t, Tsa, Tsb, Tsc) );
+    }
+private:
+    double tkill;
+};
+
+//!verification driver
+int main (int argc, char **argv) {
+
+    if ( argc != 2 )
+        print_exit("crustal_heat_verify.exe must be given a command line argument, the path to an output directory.");
+
+    //store output directory
+    std::string dirout = argv[1];
+
+    Settings base = parse_settings(problem());
+    Grid grid(base.depth, base.delz0, base.delzfrac, base.delzmax);
+
+    //--------------------------------------------------------------------------
+    //each solver against explicit steps at the stability limit
+
+    printf("solvers, largest temperature difference from explicit steps (K)\n");
+    std::vector<double> Tref = final_temperatures(base, "explicit", dirout);
+
+    Settings stg = base;
+    stg.implicit = true;
+    stg.theta = 0.5;
+    stg.dTstep = 0.05;
+    check("implicit (Crank-Nicolson)", maxdiff(final_temperatures(stg, "implicit", dirout), Tref), 1e-3);
+
+    stg = base;
+    stg.rkc = true;
+    stg.dTstep = 0.05;
+    check("Runge-Kutta-Chebyshev", maxdiff(final_temperatures(stg, "rkc", dirout), Tref), 1e-3);
+
+    stg = base;
+    stg.nlevel = 4;
+    check("multirate", maxdiff(final_temperatures(stg, "multirate", dirout), Tref), 1e-4);
+
+    stg = base;
+    stg.implicit = true;
+    stg.theta = 0.5;
+    stg.adaptive = true;
+    check("adaptive (Crank-Nicolson)", maxdiff(final_temperatures(stg, "adaptive", dirout), Tref), 1e-3);
+
+    //without latent heat, integrating enthalpy is integrating temperature
+    stg = base;
+    stg.enthalpy = true;
+    check("enthalpy", maxdiff(final_temperatures(stg, "enthalpy", dirout), Tref), 1e-9);
+
+    //the periodic state returns to itself over a period of explicit steps
+    {
+        stg = base;
+        stg.implicit = true;
+        stg.theta = 0.5;
+        stg.nmaxout = 1000;
+        stg.Tsc = base.tunit;
+        PeriodicHeat per(grid, stg);
+        per.set_quiet(true);
+        per.set_name("periodic");
+        per.solve_periodic(stg.Tsc, stg.nsnap, dirout.c_str());
+        std::vector<double> Tper(per.get_sol(), per.get_sol() + per.n);
+        stg = base;
+        stg.Tsc = base.tunit;
+        PeriodicHeat ref(grid, stg);
+        ref.set_quiet(true);
+        ref.set_name("periodic_explicit");
+        for (long i=0; i<ref.n; i++) ref.set_sol(i, Tper[i]);
+        ref.solve(stg.Tsc, stg.nsnap, dirout.c_str());
+        check("periodic", maxdiff(std::vector<double>(ref.get_sol(), ref.get_sol() + ref.n), Tper), 1e-3);
+    }
+
+    //--------------------------------------------------------------------------
+    //trials integrated together against the same trials integrated alone
+
+    printf("sweeps, largest relative difference of reductions from Heat::solve\n");
+    //swept values, with and without latent heat, and reductions of each trial
+    std::vector< std::vector<std::string> > sv = problem();
+    sv.push_back({"k0", "list(1, 2, 3)"});
+    sv.push_back({"qgeo0", "list(0.03, 0.06)"});
+    sv.push_back({"Tsb", "list(280, 300)"});
+    sv.push_back({"trial_files", "false"});
+    std::vector<Reducer> reducers = {
+        Reducer("Tsurf", reduce_final, event_probe, 0.0, 0, 1.0),
+        Reducer("qsmax", reduce_max, event_qs),
+        Reducer("Tminint", reduce_integral, event_Tmin)
+    };
+    for (int latent=1; latent>=0; latent--) {
+        std::vector< std::vector<std::string> > svl = sv;
+        svl.push_back({"LH", latent ? "6.68e7" : "0"});
+        Sweep sweep(svl);
+        for (unsigned long j=0; j<reducers.size(); j++) sweep.add_reducer(reducers[j]);
+        //with latent heat, trials are batched by HeatBatch, and without it, superposed by HeatLinear
+        sweep.run(dirout, NULL, NULL);
+        double err = 0.0;
+        for (long long i=0; i<sweep.get_ntrial(); i++) {
+            Settings s = sweep.trial(i);
+            Heat heat(grid, s);
+            heat.set_quiet(true);
+            heat.set_name("trial");
+            for (unsigned long j=0; j<reducers.size(); j++) heat.add_reducer(reducers[j]);
+            heat.solve(s.tint*s.tunit, s.nsnap, dirout.c_str());
+            for (unsigned long j=0; j<reducers.size(); j++) {
+                double a = sweep.get_summary(i, long(j)), b = heat.reducers[j].result();
+                if ( !(fabs(a - b) <= err*fabs(b)) ) err = fabs(a - b)/fabs(b);
+            }
+        }
+        check(latent ? "HeatBatch" : "HeatLinear", err, 1e-12);
+    }
+
+    //--------------------------------------------------------------------------
+    //an integration killed and resumed from its checkpoint against one that wasn't
+
+    printf("checkpoints, largest difference from an uninterrupted integration\n");
+    {
+        stg = base;
+        stg.checkpoint = 1e-9;
+        Reducer red("qsint", reduce_integral, event_qs);
+        //uninterrupted
+        Heat ref(grid, stg);
+        ref.set_quiet(true);
+        ref.set_name("uninterrupted");
+        ref.add_reducer(red);
+        ref.solve(stg.tint*stg.tunit, stg.nsnap, dirout.c_str());
+        //killed halfway through, in another process, starting over from any earlier run's checkpoint
+        remove((dirout + "/resumed_checkpoint").c_str());
+        pid_t pid = fork();
+        if ( pid == 0 ) {
+            KilledHeat killed(grid, stg, stg.tint*stg.tunit/2);
+            killed.set_quiet(true);
+            killed.set_name("resumed");
+            killed.add_reducer(red);
+            killed.solve(stg.tint*stg.tunit, stg.nsnap, dirout.c_str());
+            _exit(0);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        if ( !WIFSIGNALED(status) ) print_exit("the checkpointed integration wasn't killed");
+        //resumed
+        Heat res(grid, stg);
+        res.set_quiet(true);
+        res.set_name("resumed");
+        res.add_reducer(red);
+        res.solve(stg.tint*stg.tunit, stg.nsnap, dirout.c_str());
+        std::vector<double> a(ref.get_sol(), ref.get_sol() + ref.n), b(res.get_sol(), res.get_sol() + res.n);
+        double err = maxdiff(a, b);
+        if ( !(fabs(ref.reducers[0].result() - res.reducers[0].result()) <= err) )
+            err = fabs(ref.reducers[0].result() - res.reducers[0].result());
+        check("resumed checkpoint", err, 0.0);
+    }
+
+    if ( nfail > 0 ) {
+        printf("%li checks failed\n", nfail);
+        return(1);
+    }
+    printf("all checks passed\n");
+
+    return(0);
+}
@@ -0,0 +1,56 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+//! \file pool.h
+
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "omp.h"
+
+#include "util.h"
+#include "grid.h"
+
+//!one reusable solver for each thread, so that trials of a sweep reset a solver instead of constructing one
+/*!
+Each thread's solver is kept between calls to acquire. If the grid of the next trial on a thread matches the grid of its solver, the solver's reset function is called with the trial's arguments, which reinitializes it in the memory it already has. Otherwise a new solver, and a grid for it, are constructed. Once every thread has a solver, sweeps over settings that don't change the grid allocate nothing per trial for the solvers themselves.
+
+The solver class T may be Heat, any subclass of it, or a HeatKernel, as long as it has a constructor taking a Grid and the same arguments as its reset function. A solver returned by acquire belongs to the calling thread until that thread calls acquire again.
+*/
+template<class T>
+class SolverPool {
+public:
+
+    //!constructs an empty slot for each thread omp may use
+    SolverPool () : slots (omp_get_max_threads()) {}
+
+    //!gets the calling thread's solver, reset for a trial
+    /*!
+    \param[in] depth the total depth of the trial's grid (meters)
+    \param[in] delz0 depth of the shallowest cell of the trial's grid (meters)
+    \param[in] delzfrac fraction increase in depth of deeper cells
+    \param[in] delzmax maximum cell depth
+    \param[in] args the rest of the solver's constructor arguments, which are also its reset arguments
+    */
+    template<class... Args>
+    T &acquire (double depth, double delz0, double delzfrac, double delzmax, Args&&... args) {
+        int me = omp_get_thread_num();
+        if ( me >= int(slots.size()) )
+            print_exit("a SolverPool was used by more threads than omp_get_max_threads() gave when it was constructed");
+        std::unique_ptr<T> &s = slots[me];
+        if ( s && s->grid.matches(depth, delz0, delzfrac, delzmax) ) {
+            s->reset(std::forward<Args>(args)...);
+        } else {
+            s.reset(new T(Grid(depth, delz0, delzfrac, delzmax), std::forward<Args>(args)...));
+        }
+        return(*s);
+    }
+
+private:
+
+    //!solver of each thread
+    std::vector< std::unique_ptr<T> > slots;
+};
+
+#endif
@@ -0,0 +1,64 @@
+//! \file reducer.cc
+
+#include "reducer.h"
+
+Reducer::Reducer (std::string name_, ReduceKind op_, EventKind kind, double value, int direction, double depth) :
+    event (kind, value, direction, false, depth) {
+
+    name = name_;
+    op = op_;
+    acc = NAN;
+    tlast = NAN;
+    xlast = NAN;
+}
+
+void Reducer::start (double t, double x) {
+    event.start(t, x);
+    acc = op == reduce_integral ? 0.0 : x;
+    tlast = t;
+    xlast = x;
+}
+
+void Reducer::update (double t, double x) {
+    switch ( op ) {
+        case reduce_crossing:
+            event.check(t, x);
+            break;
+        case reduce_max:
+            if ( x > acc ) acc = x;
+            break;
+        case reduce_min:
+            if ( x < acc ) acc = x;
+            break;
+        case reduce_final:
+            acc = x;
+            break;
+        case reduce_integral:
+            acc += (t - tlast)*(xlast + x)/2.0;
+            break;
+    }
+    tlast = t;
+    xlast = x;
+}
+
+double Reducer::result () const {
+    return( op == reduce_crossing ? event.tcross : acc );
+}
+
+void Reducer::save (CheckpointWriter &ck) const {
+    ck.put(long(op));
+    event.save(ck);
+    ck.put(acc);
+    ck.put(tlast);
+    ck.put(xlast);
+}
+
+bool Reducer::load (CheckpointReader &ck) {
+    double acc_, tlast_, xlast_;
+    if ( !ck.expect(long(op)) || !event.load(ck) ) return(false);
+    if ( !ck.get(acc_) || !ck.get(tlast_) || !ck.get(xlast_) ) return(false);
+    acc = acc_;
+    tlast = tlast_;
+    xlast = xlast_;
+    return(true);
+}
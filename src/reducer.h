@@ -0,0 +1,72 @@
+#ifndef REDUCER_H_
+#define REDUCER_H_
+
+//! \file reducer.h
+
+#include <cmath>
+#include <string>
+
+#include "event.h"
+#include "checkpoint.h"
+
+//!how a Reducer reduces its quantity to one number
+enum ReduceKind {
+    //!time of the first crossing of a threshold, NAN if there isn't one
+    reduce_crossing,
+    //!largest value
+    reduce_max,
+    //!smallest value
+    reduce_min,
+    //!value at the end of the integration
+    reduce_final,
+    //!integral over time, by the trapezoid rule over steps
+    reduce_integral
+};
+
+//!reduces a quantity monitored during an integration to a single number
+/*!
+The quantity is any that an Event monitors (see EventKind), evaluated at the start of the integration and at the end of every step, so reductions are exact over the steps taken instead of over decimated trackers. Crossings are located by an Event, which isn't terminal. The result of a reduction is NAN until it has been started, and reductions of an integration that stops early end at its last step.
+*/
+class Reducer {
+public:
+
+    //!constructs
+    /*!
+    \param[in] name name of the result, a column of a sweep's summary table
+    \param[in] op reduction
+    \param[in] kind reduced quantity
+    \param[in] value threshold of reduce_crossing
+    \param[in] direction direction of crossings for reduce_crossing, as for Event
+    \param[in] depth probe depth for event_probe (m)
+    */
+    Reducer (std::string name, ReduceKind op, EventKind kind, double value=0.0, int direction=0, double depth=0.0);
+
+    //!name of the result
+    std::string name;
+    //!reduction
+    ReduceKind op;
+    //!reduced quantity, with the threshold of crossings
+    Event event;
+
+    //!begins reducing, given the quantity at the starting time
+    void start (double t, double x);
+    //!adds the quantity at the end of a step
+    void update (double t, double x);
+    //!result of the reduction so far
+    double result () const;
+    //!writes the reduction's state to a checkpoint
+    void save (CheckpointWriter &ck) const;
+    //!restores the reduction's state from a checkpoint, returning false if it was saved from a different reduction
+    bool load (CheckpointReader &ck);
+
+private:
+
+    //!extreme, last value, or integral so far
+    double acc;
+    //!time of the last update
+    double tlast;
+    //!quantity at the last update
+    double xlast;
+};
+
+#endif
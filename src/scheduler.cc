@@ -0,0 +1,162 @@
+//! \file scheduler.cc
+
+#include "omp.h"
+
+#include "scheduler.h"
+
+//!seconds elapsed since a time point
+static double seconds_since (std::chrono::steady_clock::time_point t0) {
+    return( std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() );
+}
+
+Scheduler::Scheduler (long ntask_) {
+    ntask = ntask_;
+    units.assign(ntask, 1.0);
+    kind.assign(ntask, 0);
+    rate.assign(1, 1.0);
+    actual.assign(ntask, NAN);
+    start.assign(ntask, NAN);
+    thread.assign(ntask, -1);
+    nthread = 0;
+    makespan = NAN;
+    interval = 0.0;
+}
+
+//!formats a number of seconds as hours, minutes, and seconds
+static std::string hms (double s) {
+    char buf[64];
+    long x = long(s + 0.5);
+    snprintf(buf, sizeof(buf), "%li:%02li:%02li", x/3600, (x/60) % 60, x % 60);
+    return(std::string(buf));
+}
+
+void Scheduler::set_cost (long i, double units_, long kind_) {
+    if ( kind_ < 0 ) print_exit("Scheduler cost kinds must not be negative");
+    units[i] = units_;
+    kind[i] = kind_;
+    if ( kind_ >= long(rate.size()) ) rate.resize(kind_ + 1, 1.0);
+}
+
+void Scheduler::calibrate (long kind_, double rate_) {
+    if ( kind_ < 0 ) print_exit("Scheduler cost kinds must not be negative");
+    if ( kind_ >= long(rate.size()) ) rate.resize(kind_ + 1, 1.0);
+    rate[kind_] = rate_;
+}
+
+double Scheduler::predicted (long i) const {
+    return( units[i]*rate[kind[i]] );
+}
+
+void Scheduler::run (std::function<void(long)> task) {
+
+    //longest first
+    std::vector<long> order(ntask);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [this](long a, long b){ return( predicted(a) > predicted(b) ); });
+
+    //deal the tasks round robin, so every thread starts on a long one
+    nthread = omp_get_max_threads();
+    std::vector< std::deque<long> > queue(nthread);
+    std::vector<double> load(nthread, 0.0);
+    std::vector<std::mutex> lock(nthread);
+    for (long j=0; j<ntask; j++) {
+        queue[j % nthread].push_back(order[j]);
+        load[j % nthread] += predicted(order[j]);
+    }
+
+    //progress of the whole run
+    double total = 0.0, done = 0.0, tlast = 0.0;
+    long ndone = 0;
+    std::mutex plock;
+    for (long j=0; j<ntask; j++) total += predicted(j);
+
+    auto t0 = std::chrono::steady_clock::now();
+    #pragma omp parallel num_threads(nthread)
+    {
+        int me = omp_get_thread_num();
+        while ( true ) {
+            long i = -1;
+            //take the longest task left in this thread's queue
+            {
+                std::lock_guard<std::mutex> guard(lock[me]);
+                if ( !queue[me].empty() ) {
+                    i = queue[me].front();
+                    queue[me].pop_front();
+                    load[me] -= predicted(i);
+                }
+            }
+            //otherwise steal the shortest task of the most loaded thread
+            while ( i < 0 ) {
+                int victim = -1;
+                double most = 0.0;
+                for (int v=0; v<nthread; v++) {
+                    std::lock_guard<std::mutex> guard(lock[v]);
+                    if ( !queue[v].empty() && ((victim < 0) || (load[v] > most)) ) {
+                        victim = v;
+                        most = load[v];
+                    }
+                }
+                //nothing left anywhere
+                if ( victim < 0 ) break;
+                std::lock_guard<std::mutex> guard(lock[victim]);
+                if ( !queue[victim].empty() ) {
+                    i = queue[victim].back();
+                    queue[victim].pop_back();
+                    load[victim] -= predicted(i);
+                }
+            }
+            if ( i < 0 ) break;
+            //run it
+            double ts = seconds_since(t0);
+            task(i);
+            start[i] = ts;
+            actual[i] = seconds_since(t0) - ts;
+            thread[i] = me;
+            //report progress
+            if ( interval > 0 ) {
+                std::lock_guard<std::mutex> guard(plock);
+                ndone++;
+                done += predicted(i);
+                double te = seconds_since(t0);
+                if ( (te - tlast >= interval) || (ndone == ntask) ) {
+                    tlast = te;
+                    printf("  %li/%li tasks finished, %g tasks/s, %s elapsed, %s left\n",
+                        ndone, ntask, ndone/te, hms(te).c_str(),
+                        done > 0 ? hms(te*(total - done)/done).c_str() : "?");
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+    makespan = seconds_since(t0);
+}
+
+void Scheduler::print_report () const {
+
+    //fitted cost per unit of each kind, and total busy time
+    long nkind = long(rate.size());
+    std::vector<double> sa(nkind, 0.0), su(nkind, 0.0);
+    double busy = 0.0;
+    for (long i=0; i<ntask; i++) {
+        if ( std::isnan(actual[i]) ) continue;
+        sa[kind[i]] += actual[i];
+        su[kind[i]] += units[i];
+        busy += actual[i];
+    }
+
+    printf("scheduler: %li tasks on %d threads, makespan %g s, %g %% idle\n",
+        ntask, nthread, makespan, 100*(1 - busy/(nthread*makespan)));
+    for (long k=0; k<nkind; k++)
+        if ( su[k] > 0 )
+            printf("  kind %li: calibrated %g, fitted %g s per unit\n", k, rate[k], sa[k]/su[k]);
+}
+
+void Scheduler::write_report (const std::string &fn) const {
+    check_file_write(fn.c_str());
+    FILE *ofile = fopen(fn.c_str(), "w");
+    fprintf(ofile, "task,kind,units,predicted,actual (s),start (s),thread\n");
+    for (long i=0; i<ntask; i++)
+        fprintf(ofile, "%li,%li,%g,%g,%g,%g,%d\n", i, kind[i], units[i], predicted(i), actual[i], start[i], thread[i]);
+    fclose(ofile);
+}
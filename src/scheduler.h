@@ -0,0 +1,83 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+//! \file scheduler.h
+
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+
+#include "io.h"
+
+//!runs independent tasks of very different cost over OpenMP threads, longest first, with work stealing
+/*!
+Each task is given a predicted cost before running, as a number of work units (like cells times right-hand side evaluations) and a kind (like a boundary condition mode), with a calibrated cost per unit for each kind. The kinds may be calibrated by timing short pilot runs, for example with Heat::time_rhs().
+
+Tasks are sorted by predicted cost and dealt round robin into a queue for each thread, so every thread starts on one of the most expensive tasks. Threads take tasks from the front of their own queue (longest first), then, when it's empty, steal from the back of the queue with the most predicted work left. The estimated time left in progress reports is the elapsed time scaled by the ratio of predicted cost left to predicted cost finished. The actual time of every task is recorded, so predicted and actual costs can be compared with print_report() and write_report() to tune the cost model.
+*/
+class Scheduler {
+public:
+
+    //!constructs
+    /*!
+    \param[in] ntask number of tasks, numbered from zero
+    */
+    Scheduler (long ntask);
+
+    //!sets the predicted cost of a task
+    /*!
+    \param[in] i task number
+    \param[in] units predicted work units
+    \param[in] kind cost kind, from zero, each with its own cost per unit
+    */
+    void set_cost (long i, double units, long kind=0);
+    //!sets the cost per work unit of a kind of task, 1 by default
+    void calibrate (long kind, double rate);
+    //!predicted cost of a task, in the units of the calibrated rates
+    double predicted (long i) const;
+    //!prints progress, throughput, and the estimated time left while running, at most every interval seconds (0 for none)
+    void set_progress (double interval_) { interval = interval_; }
+
+    //!runs every task over the OpenMP threads
+    /*!
+    \param[in] task function running a task, given its number
+    */
+    void run (std::function<void(long)> task);
+
+    //!prints the makespan, idle time, and the fitted cost per unit of each kind
+    void print_report () const;
+    //!writes a csv with the predicted and actual cost of every task
+    void write_report (const std::string &fn) const;
+
+private:
+
+    //!number of tasks
+    long ntask;
+    //!predicted work units of each task
+    std::vector<double> units;
+    //!cost kind of each task
+    std::vector<long> kind;
+    //!cost per unit of each kind
+    std::vector<double> rate;
+    //!actual time of each task (s)
+    std::vector<double> actual;
+    //!start time of each task, from the start of run (s)
+    std::vector<double> start;
+    //!thread that ran each task
+    std::vector<int> thread;
+    //!number of threads used by run
+    int nthread;
+    //!total time of run (s)
+    double makespan;
+    //!seconds between progress reports
+    double interval;
+};
+
+#endif
@@ -0,0 +1,92 @@
+//! \file series.cc
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "series.h"
+
+std::shared_ptr<const Series> Series::open (const std::string &fnx, const std::string &fny) {
+    //series open in this process, freed when no trial uses them
+    static std::mutex lock;
+    static std::map<std::string, std::weak_ptr<const Series>> cache;
+    std::lock_guard<std::mutex> guard(lock);
+    std::string key = fnx + '\n' + fny;
+    std::shared_ptr<const Series> s = cache[key].lock();
+    if ( !s ) {
+        s = std::make_shared<const Series>(fnx, fny);
+        cache[key] = s;
+    }
+    return(s);
+}
+
+Series::Series (const std::string &fnx, const std::string &fny) {
+    x.load(fnx);
+    y.load(fny);
+    if ( x.n != y.n )
+        print_exit(("series files " + fnx + " and " + fny + " have different lengths").c_str());
+    n = x.n;
+    //binary searches need sorted times
+    for (long i=1; i<n; i++)
+        if ( !(x.ptr[i] > x.ptr[i-1]) )
+            print_exit(("series times in " + fnx + " are not strictly increasing").c_str());
+}
+
+Series::~Series () {
+    x.unload();
+    y.unload();
+}
+
+void Series::Column::load (const std::string &fn) {
+    check_file_read(fn.c_str());
+    int fd = ::open(fn.c_str(), O_RDONLY);
+    struct stat st;
+    if ( (fd < 0) || (fstat(fd, &st) != 0) )
+        print_exit(("cannot open series file " + fn).c_str());
+    len = size_t(st.st_size);
+    if ( (len == 0) || (len % sizeof(double) != 0) )
+        print_exit(("series file " + fn + " isn't a nonempty array of doubles").c_str());
+    n = long(len/sizeof(double));
+    if ( len >= SERIES_MMAP_BYTES ) {
+        map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if ( map == MAP_FAILED ) map = NULL;
+    }
+    if ( map != NULL ) {
+        ptr = (const double*)map;
+    } else {
+        //small files, or if mapping fails
+        v.resize(n);
+        if ( pread(fd, v.data(), len, 0) != (ssize_t)len )
+            print_exit(("cannot read series file " + fn).c_str());
+        ptr = v.data();
+    }
+    close(fd);
+}
+
+void Series::Column::unload () {
+    if ( map != NULL ) munmap(map, len);
+    map = NULL;
+}
+
+SeriesCursor::SeriesCursor (std::shared_ptr<const Series> s_) :
+    s (s_),
+    x (s_->get_x()),
+    y (s_->get_y()),
+    n (s_->size()),
+    j (0) {}
+
+double SeriesCursor::operator() (double xx) {
+    //clamp to the ends
+    if ( xx <= x[0] ) return(y[0]);
+    if ( xx >= x[n-1] ) return(y[n-1]);
+    //the last interval, then the next, then a binary search, choosing
+    //the lower interval at a sample time, as interp() does
+    if ( !((x[j] < xx) && (xx <= x[j+1])) ) {
+        if ( (j + 2 < n) && (x[j+1] < xx) && (xx <= x[j+2]) )
+            j++;
+        else
+            j = long(std::lower_bound(x, x + n, xx) - x) - 1;
+    }
+    return( y[j] + (xx - x[j])*(y[j+1] - y[j])/(x[j+1] - x[j]) );
+}
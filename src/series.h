@@ -0,0 +1,97 @@
+#ifndef SERIES_H_
+#define SERIES_H_
+
+//! \file series.h
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+
+#include "io.h"
+
+//!series at least this many bytes long are memory-mapped instead of read into memory
+#define SERIES_MMAP_BYTES 1048576
+
+//!read-only forcing series, like a surface temperature record, shared by every trial in a process
+/*!
+A series is a pair of binary files of doubles, the times (or other coordinates) and the values, with the same length. Series are opened through Series::open(), which returns the series already open for the same files, if any, so every trial shares one copy. Files of at least SERIES_MMAP_BYTES are memory-mapped, so even multi-million sample records are paged in by the operating system instead of copied. Values are looked up with a SeriesCursor.
+*/
+class Series {
+public:
+
+    //!opens a series, or shares the one already open for the same files
+    /*!
+    \param[in] fnx path to the binary file of strictly increasing times
+    \param[in] fny path to the binary file of values
+    */
+    static std::shared_ptr<const Series> open (const std::string &fnx, const std::string &fny);
+
+    //!reads or maps the files (use Series::open to share them)
+    Series (const std::string &fnx, const std::string &fny);
+    //!unmaps the files
+    ~Series ();
+    Series (const Series&) = delete;
+    Series &operator= (const Series&) = delete;
+
+    //!number of samples
+    long size () const { return(n); }
+    //!times
+    const double *get_x () const { return(x.ptr); }
+    //!values
+    const double *get_y () const { return(y.ptr); }
+    //!whether the files are memory-mapped
+    bool mapped () const { return(x.map != NULL); }
+
+private:
+
+    //!one file of doubles, either mapped or read into memory
+    struct Column {
+        const double *ptr = NULL;
+        long n = 0;
+        void *map = NULL;
+        size_t len = 0;
+        std::vector<double> v;
+        //!reads or maps a file
+        void load (const std::string &fn);
+        //!unmaps the file, if mapped
+        void unload ();
+    };
+
+    //!number of samples
+    long n;
+    //!times
+    Column x;
+    //!values
+    Column y;
+};
+
+//!linear interpolation of a Series, remembering the last interval used
+/*!
+Integrations look up a forcing series at slowly increasing times, so the cursor first checks the interval used last and the one after it, which makes lookups O(1) amortized instead of the O(n) scan of interp(). Any other time falls back to a binary search. Values outside the series are clamped to its ends, as with interp(). Each integration should have its own cursor.
+*/
+class SeriesCursor {
+public:
+    //!constructs an empty cursor, which must be given a series before use
+    SeriesCursor () : x (NULL), y (NULL), n (0), j (0) {}
+    //!constructs a cursor over a series
+    SeriesCursor (std::shared_ptr<const Series> s);
+    //!interpolates the series at a time
+    double operator() (double xx);
+    //!moves the cursor back to the start of the series
+    void rewind () { j = 0; }
+private:
+    //!series, held so it stays open
+    std::shared_ptr<const Series> s;
+    //!times and values
+    const double *x, *y;
+    //!number of samples
+    long n;
+    //!start of the last interval used
+    long j;
+};
+
+#endif
@@ -17,61 +17,126 @@ long to_long(const char *val) {
     return( long(std::atof(val)) );
 }
 
+//------------------------------------------------------------------------------
+//registry of Settings fields
+
+//!a registry entry for each type of field
+#define SETTING_DOUBLE(x) {#x, setting_double, &Settings::x, NULL, NULL}
+#define SETTING_LONG(x)   {#x, setting_long, NULL, &Settings::x, NULL}
+#define SETTING_BOOL(x)   {#x, setting_bool, NULL, NULL, &Settings::x}
+
+//!every field of Settings, by its name in settings files
+static const SettingField fields[] = {
+    //grid
+    SETTING_DOUBLE(depth),
+    SETTING_DOUBLE(delz0),
+    SETTING_DOUBLE(delzfrac),
+    SETTING_DOUBLE(delzmax),
+    SETTING_BOOL(save_grid),
+    //model
+    SETTING_DOUBLE(tint),
+    SETTING_DOUBLE(tunit),
+    SETTING_LONG(nsnap),
+    SETTING_LONG(nmaxout),
+    SETTING_DOUBLE(dtfac),
+    SETTING_BOOL(steady),
+    SETTING_LONG(nlevel),
+    SETTING_BOOL(implicit),
+    SETTING_BOOL(rkc),
+    SETTING_BOOL(enthalpy),
+    SETTING_DOUBLE(theta),
+    SETTING_DOUBLE(dTstep),
+    SETTING_LONG(npicard),
+    SETTING_BOOL(adaptive),
+    SETTING_DOUBLE(rtol),
+    SETTING_DOUBLE(atol),
+    SETTING_DOUBLE(ptol),
+    SETTING_LONG(nkrylov),
+    SETTING_BOOL(archive),
+    SETTING_BOOL(async_write),
+    SETTING_LONG(nqueue),
+    SETTING_DOUBLE(progress),
+    SETTING_DOUBLE(checkpoint),
+    //physical
+    SETTING_DOUBLE(rho0),
+    SETTING_DOUBLE(c0),
+    SETTING_DOUBLE(k0),
+    SETTING_DOUBLE(qgeo0),
+    SETTING_DOUBLE(Tsa),
+    SETTING_DOUBLE(Tsb),
+    SETTING_DOUBLE(Tsc),
+    SETTING_BOOL(radiative),
+    SETTING_DOUBLE(emissivity),
+    SETTING_DOUBLE(Fabs),
+    SETTING_DOUBLE(LH),
+    SETTING_DOUBLE(Tf),
+    SETTING_DOUBLE(ahcw),
+    //trackers and output
+    SETTING_BOOL(rho),
+    SETTING_BOOL(c),
+    SETTING_BOOL(k),
+    SETTING_BOOL(cap),
+    SETTING_BOOL(T),
+    SETTING_BOOL(dTdz),
+    SETTING_BOOL(q),
+    SETTING_BOOL(Tmax),
+    SETTING_BOOL(Tmin),
+    SETTING_BOOL(Ts),
+    SETTING_BOOL(qs),
+    SETTING_BOOL(t),
+    SETTING_BOOL(dt),
+    SETTING_BOOL(tsnap),
+    SETTING_BOOL(trial_files),
+    //diagnostics
+    SETTING_LONG(nprobe),
+    SETTING_DOUBLE(probe0),
+    SETTING_DOUBLE(probe1),
+    SETTING_DOUBLE(Tiso),
+    SETTING_BOOL(ziso),
+    SETTING_BOOL(zthaw),
+    SETTING_BOOL(E),
+    SETTING_BOOL(Qs)
+};
+
+//!number of registered fields
+static const long nfields = long(sizeof(fields)/sizeof(fields[0]));
+
+const SettingField *find_setting (const char *name) {
+    for (long i=0; i<nfields; i++)
+        if ( cmp(fields[i].name, name) ) return(fields + i);
+    return(NULL);
+}
+
+bool is_sweep_value (const char *val) {
+    return( (strncmp(val, "lin(", 4) == 0) || (strncmp(val, "log(", 4) == 0) || (strncmp(val, "list(", 5) == 0) );
+}
+
+void assign_setting (Settings &s, const char *set, const char *val) {
+    const SettingField *f = find_setting(set);
+    if ( f == NULL ) {
+        std::cout << "FAILURE: unknown setting in settings file: " << set << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if ( is_sweep_value(val) ) {
+        std::cout << "FAILURE: setting " << set << " is a sweep (" << val << "), which only sweep drivers can run" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    switch ( f->type ) {
+        case setting_double: s.*(f->d) = std::atof(val); break;
+        case setting_long: s.*(f->l) = to_long(val); break;
+        case setting_bool: s.*(f->b) = eval_txt_bool(val); break;
+    }
+}
+
+//------------------------------------------------------------------------------
+
 Settings parse_settings ( std::vector< std::vector< std::string > > sv ) {
 
     Settings s;
-    const char *set, *val;
-
-    for (int i=0; i < int(sv.size()); i++) {
-
-        //get the setting and value pair
-        set = sv[i][0].c_str();
-        val = sv[i][1].c_str();
-
-        //get the setting
-
-        if      ( cmp(set, "depth") ) s.depth = std::atof(val);
-        else if ( cmp(set, "delz0") ) s.delz0 = std::atof(val);
-        else if ( cmp(set, "delzfrac") ) s.delzfrac = std::atof(val);
-        else if ( cmp(set, "delzmax") ) s.delzmax = std::atof(val);
-        else if ( cmp(set, "save_grid") ) s.save_grid = eval_txt_bool(val);
-
-        else if ( cmp(set, "tint") ) s.tint = std::atof(val);
-        else if ( cmp(set, "tunit") ) s.tunit = std::atof(val);
-        else if ( cmp(set, "nsnap") ) s.nsnap = to_long(val);
-        else if ( cmp(set, "nmaxout") ) s.nmaxout = to_long(val);
-        else if ( cmp(set, "dtfac") ) s.dtfac = std::atof(val);
-
-        else if ( cmp(set, "rho0") ) s.rho0 = std::atof(val);
-        else if ( cmp(set, "c0") ) s.c0 = std::atof(val);
-        else if ( cmp(set, "k0") ) s.k0 = std::atof(val);
-        else if ( cmp(set, "qgeo0") ) s.qgeo0 = std::atof(val);
-        else if ( cmp(set, "Tsa") ) s.Tsa = std::atof(val);
-        else if ( cmp(set, "Tsb") ) s.Tsb = std::atof(val);
-        else if ( cmp(set, "Tsc") ) s.Tsc = std::atof(val);
-        else if ( cmp(set, "LH") ) s.LH = std::atof(val);
-        else if ( cmp(set, "Tf") ) s.Tf = std::atof(val);
-        else if ( cmp(set, "ahcw") ) s.ahcw = std::atof(val);
-
-        else if ( cmp(set, "rho") ) s.rho = eval_txt_bool(val);
-        else if ( cmp(set, "c") ) s.c = eval_txt_bool(val);
-        else if ( cmp(set, "k") ) s.k = eval_txt_bool(val);
-        else if ( cmp(set, "cap") ) s.cap = eval_txt_bool(val);
-        else if ( cmp(set, "T") ) s.T = eval_txt_bool(val);
-        else if ( cmp(set, "dTdz") ) s.dTdz = eval_txt_bool(val);
-        else if ( cmp(set, "q") ) s.q = eval_txt_bool(val);
-        else if ( cmp(set, "Tmax") ) s.Tmax = eval_txt_bool(val);
-        else if ( cmp(set, "Tmin") ) s.Tmin = eval_txt_bool(val);
-        else if ( cmp(set, "Ts") ) s.Ts = eval_txt_bool(val);
-        else if ( cmp(set, "qs") ) s.qs = eval_txt_bool(val);
-        else if ( cmp(set, "t") ) s.t = eval_txt_bool(val);
-        else if ( cmp(set, "tsnap") ) s.tsnap = eval_txt_bool(val);
-
-        else {
-            std::cout << "FAILURE: unknown setting in settings file: " << set << std::endl;
-            exit(EXIT_FAILURE);
-        }
-    }
+
+    //assign each setting and value pair through the registry
+    for (int i=0; i < int(sv.size()); i++)
+        assign_setting(s, sv[i][0].c_str(), sv[i][1].c_str());
 
     return(s);
 }
@@ -79,43 +144,14 @@ Settings parse_settings ( std::vector< std::vector< std::string > > sv ) {
 Settings copy_settings (Settings &b) {
 
     Settings a;
-    //grid
-    a.depth = b.depth;
-    a.delz0 = b.delz0;
-    a.delzfrac = b.delzfrac;
-    a.delzmax = b.delzmax;
-    a.save_grid = b.save_grid;
-    //model
-    a.tint = b.tint;
-    a.tunit = b.tunit;
-    a.nsnap = b.nsnap;
-    a.nmaxout = b.nmaxout;
-    a.dtfac = b.dtfac;
-    //physical
-    a.rho0 = b.rho0;
-    a.c0 = b.c0;
-    a.k0 = b.k0;
-    a.qgeo0 = b.qgeo0;
-    a.Tsa = b.Tsa;
-    a.Tsb = b.Tsb;
-    a.Tsc = b.Tsc;
-    a.LH = b.LH;
-    a.Tf = b.Tf;
-    a.ahcw = b.ahcw;
-    //trackers and output
-    a.rho = b.rho;
-    a.c = b.c;
-    a.k = b.k;
-    a.cap = b.cap;
-    a.T = b.T;
-    a.dTdz = b.dTdz;
-    a.q = b.q;
-    a.Tmax = b.Tmax;
-    a.Tmin = b.Tmin;
-    a.Ts = b.Ts;
-    a.qs = b.qs;
-    a.t = b.t;
-    a.tsnap = b.tsnap;
+    //copy every registered field
+    for (long i=0; i<nfields; i++) {
+        switch ( fields[i].type ) {
+            case setting_double: a.*(fields[i].d) = b.*(fields[i].d); break;
+            case setting_long: a.*(fields[i].l) = b.*(fields[i].l); break;
+            case setting_bool: a.*(fields[i].b) = b.*(fields[i].b); break;
+        }
+    }
 
     return(a);
 }
@@ -36,10 +36,46 @@ public:
     double tunit = 1.0;
     //!number of snaps to take
     long nsnap = 5;
-    //!maximum length of output vectors (subsampled to accomodate)
+    //!maximum length of tracker output vectors (decimated as the integration runs)
     long nmaxout = 100;
     //!safety factor for stable time step
     double dtfac = 0.9;
+    //!whether Heat::solve starts from the steady state of the boundary conditions at its starting time, with every edge carrying the geothermal flux, instead of the initial geotherm
+    bool steady = false;
+    //!maximum number of time step levels of explicit solves, each stepping twice as far as the one before it, or 1 for the same step in every cell
+    long nlevel = 1;
+    //!whether to use the implicit tridiagonal solver instead of explicit steps
+    bool implicit = false;
+    //!whether explicit steps are Runge-Kutta-Chebyshev steps, stable at any step size with enough stages, sized like implicit steps
+    bool rkc = false;
+    //!whether explicit steps integrate enthalpy, with a sharp phase change at Tf, instead of temperature with an apparent capacity
+    bool enthalpy = false;
+    //!implicitness of the implicit solver (1 for backward Euler, 0.5 for Crank-Nicolson)
+    double theta = 1.0;
+    //!target for the largest temperature change in one implicit step (K)
+    double dTstep = 1.0;
+    //!maximum number of Picard iterations for each implicit step
+    long npicard = 25;
+    //!whether Heat::solve sizes its steps by an embedded estimate of their local error instead of by stability (explicit) or dTstep (implicit)
+    bool adaptive = false;
+    //!relative tolerance of the local error of adaptive steps
+    double rtol = 1e-6;
+    //!absolute tolerance of the local error of adaptive steps (K)
+    double atol = 1e-4;
+    //!tolerance of Heat::solve_periodic, the largest change of any cell's temperature over one period of the converged cycle (K)
+    double ptol = 1e-6;
+    //!maximum number of Krylov vectors (one-period integrations) in each Newton iteration of Heat::solve_periodic
+    long nkrylov = 40;
+    //!whether to write all output into a single archive file instead of a file for each variable
+    bool archive = false;
+    //!whether to hand output to a background thread instead of writing it on the integrating thread
+    bool async_write = false;
+    //!maximum number of writes queued for the background thread
+    long nqueue = 256;
+    //!wall clock seconds between progress reports of sweeps, or 0 for none
+    double progress = 0.0;
+    //!wall clock seconds between checkpoints of Heat::solve and HeatBatch::solve, or 0 for none
+    double checkpoint = 0.0;
 
     //-------------------------------------
     //physical parameters
@@ -58,6 +94,12 @@ public:
     double Tsb = 1.0;
     //!third surface temperature parameter
     double Tsc = 1.0;
+    //!whether the surface temperature is set by radiation balance instead of Tsa, Tsb, and Tsc
+    bool radiative = false;
+    //!emissivity of a radiative surface
+    double emissivity = 1.0;
+    //!flux absorbed by a radiative surface (W/m^2)
+    double Fabs = 0.0;
     //!latent heat of medium (J/m^3) <--- UNITS!
     /*!
         - multiply by porosity for ice/water in pores
@@ -96,8 +138,32 @@ public:
     bool qs = false;
     //!whether to track time step times
     bool t = false;
+    //!whether to track time step sizes
+    bool dt = false;
     //!whether to track time snap times
     bool tsnap = false;
+    //!whether each trial writes its own output files, which sweeps reducing their trials into a summary table may not need
+    bool trial_files = true;
+
+    //-------------------------------------
+    //diagnostics, tracked after every step (see Diagnostics)
+
+    //!number of temperature probes, evenly spaced in depth from probe0 to probe1
+    long nprobe = 0;
+    //!depth of the first probe (m)
+    double probe0 = 0.0;
+    //!depth of the last probe (m)
+    double probe1 = 0.0;
+    //!temperature of the isotherm found by the ziso and zthaw diagnostics (K)
+    double Tiso = 273.0;
+    //!whether to track the depth of the shallowest Tiso isotherm
+    bool ziso = false;
+    //!whether to track the thaw depth, the bottom of the surface layer warmer than Tiso, as the largest in each bucket (the active layer thickness)
+    bool zthaw = false;
+    //!whether to track the heat content of the column
+    bool E = false;
+    //!whether to track the heat lost through the surface since the start of the integration
+    bool Qs = false;
 
 };
 
@@ -110,6 +176,40 @@ bool cmp (const char *s1, const char *s2);
 //!converts a character to an integet
 long to_long(const char *val);
 
+//!types of Settings fields
+enum SettingType {setting_double, setting_long, setting_bool};
+
+//!registry entry mapping a name in settings files to a field of Settings
+/*!
+Only the member pointer matching the type is set. Every field of Settings must have an entry in the registry (in settings.cc), which is used to parse settings files, copy Settings, and vary settings in sweeps.
+*/
+struct SettingField {
+    //!name of the setting in settings files
+    const char *name;
+    //!type of the field
+    SettingType type;
+    //!double field
+    double Settings::*d;
+    //!long field
+    long Settings::*l;
+    //!bool field
+    bool Settings::*b;
+};
+
+//!finds a field in the registry by name, returning NULL if there isn't one
+const SettingField *find_setting (const char *name);
+
+//!whether a value in a settings file is a sweep specification, like lin(...), log(...), or list(...)
+bool is_sweep_value (const char *val);
+
+//!sets a field of a Settings object from its name and text value, exiting if the name is unknown or the value is a sweep
+/*!
+\param[in,out] s Settings object to modify
+\param[in] set name of the setting
+\param[in] val text value of the setting
+*/
+void assign_setting (Settings &s, const char *set, const char *val);
+
 //!parses a settings file and returns it in a Settings structure
 /*!
 \param[in] sv vector of vectors of strings from read_values_file()
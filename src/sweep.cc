@@ -0,0 +1,488 @@
+//! \file sweep.cc
+
+#include <algorithm>
+
+#include "omp.h"
+
+#include "sweep.h"
+
+//!settings that may differ between the lanes of a HeatBatch
+static const std::vector<std::string> lane_keys = {
+    "k0", "qgeo0", "Tsa", "Tsb", "Tsc", "rho0", "c0", "LH", "Tf", "ahcw"
+};
+
+//!settings superposed by a HeatLinear
+static const std::vector<std::string> linear_keys = {
+    "Tsa", "Tsb", "qgeo0"
+};
+
+//!settings that decide whether a problem is linear
+static const std::vector<std::string> nonlinear_keys = {
+    "LH", "radiative", "enthalpy"
+};
+
+//!settings defining the grid
+static const std::vector<std::string> grid_keys = {
+    "depth", "delz0", "delzfrac", "delzmax"
+};
+
+//!formats a number so that it's read back exactly
+static std::string format_value (double x) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.17g", x);
+    return(std::string(buf));
+}
+
+//!expands lin(a, b, n), log(a, b, n), or list(v1, v2, ...) into its values
+static std::vector<std::string> expand_sweep_value (const std::string &key, const std::string &val) {
+
+    std::string::size_type i = val.find('('), j = val.rfind(')');
+    if ( (i == std::string::npos) || (j == std::string::npos) || (j < i) ) {
+        std::cout << "FAILURE: malformed sweep for " << key << ": " << val << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::string kind = val.substr(0, i);
+    std::string rest = val.substr(i+1, j-i-1);
+
+    //split the arguments on commas
+    std::vector<std::string> args;
+    std::string a, b;
+    while ( rest.find(',') != std::string::npos ) {
+        split_string(',', rest, a, b);
+        strip_string(a);
+        args.push_back(a);
+        rest = b;
+    }
+    strip_string(rest);
+    if ( rest.length() > 0 ) args.push_back(rest);
+
+    //generate the values
+    std::vector<std::string> values;
+    if ( kind == "list" ) {
+        values = args;
+    } else {
+        if ( args.size() != 3 ) {
+            std::cout << "FAILURE: " << kind << "() needs three arguments for " << key << ": " << val << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::vector<double> x;
+        if ( kind == "lin" ) x = linspace(std::atof(args[0].c_str()), std::atof(args[1].c_str()), to_long(args[2].c_str()));
+        else x = logspace(std::atof(args[0].c_str()), std::atof(args[1].c_str()), to_long(args[2].c_str()));
+        for (unsigned long k=0; k<x.size(); k++) values.push_back( format_value(x[k]) );
+    }
+    if ( values.empty() ) {
+        std::cout << "FAILURE: sweep for " << key << " has no values: " << val << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return(values);
+}
+
+//!writes a table cell, shortening numbers as printf's %g does
+static void write_cell (FILE *ofile, const std::string &v) {
+    char *end;
+    double x = strtod(v.c_str(), &end);
+    if ( (end != v.c_str()) && (*end == '\0') ) fprintf(ofile, ",%g", x);
+    else fprintf(ofile, ",%s", v.c_str());
+}
+
+//------------------------------------------------------------------------------
+
+Sweep::Sweep (std::vector< std::vector< std::string > > sv, std::vector<std::string> extra_) {
+
+    extra = extra_;
+    extra_values.resize(extra.size());
+
+    for (unsigned long i=0; i<sv.size(); i++) {
+        std::string &key = sv[i][0], &val = sv[i][1];
+        //find driver parameters
+        long e = -1;
+        for (unsigned long j=0; j<extra.size(); j++)
+            if ( extra[j] == key ) e = long(j);
+        if ( (e < 0) && (find_setting(key.c_str()) == NULL) ) {
+            std::cout << "FAILURE: unknown setting in settings file: " << key << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        //store swept parameters and assign fixed ones
+        if ( is_sweep_value(val.c_str()) ) {
+            if ( varies(key) ) {
+                std::cout << "FAILURE: setting swept twice: " << key << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            SweepParam p;
+            p.key = key;
+            p.values = expand_sweep_value(key, val);
+            p.setting = e < 0;
+            params.push_back(p);
+        } else if ( e >= 0 ) {
+            extra_values[e] = val;
+        } else {
+            assign_setting(base, key.c_str(), val.c_str());
+        }
+    }
+
+    //total number of combinations
+    ntrial = 1;
+    for (unsigned long i=0; i<params.size(); i++) ntrial *= (long long)params[i].values.size();
+}
+
+bool Sweep::varies (const std::string &key) const {
+    for (unsigned long i=0; i<params.size(); i++)
+        if ( params[i].key == key ) return(true);
+    return(false);
+}
+
+bool Sweep::varies_only (const std::vector<std::string> &keys) const {
+    for (unsigned long i=0; i<params.size(); i++) {
+        if ( !params[i].setting ) continue;
+        bool found = false;
+        for (unsigned long j=0; j<keys.size(); j++)
+            if ( params[i].key == keys[j] ) found = true;
+        if ( !found ) return(false);
+    }
+    return(true);
+}
+
+std::vector<long> Sweep::decode (long long i) const {
+    //mixed radix digits of the trial number, the last parameter fastest
+    std::vector<long> idx(params.size());
+    for (long j=long(params.size())-1; j>=0; j--) {
+        long long m = (long long)params[j].values.size();
+        idx[j] = long(i % m);
+        i /= m;
+    }
+    return(idx);
+}
+
+std::string Sweep::value (long long i, const std::string &key) const {
+    std::vector<long> idx = decode(i);
+    for (unsigned long j=0; j<params.size(); j++)
+        if ( params[j].key == key ) return(params[j].values[idx[j]]);
+    for (unsigned long j=0; j<extra.size(); j++)
+        if ( (extra[j] == key) && (extra_values[j].length() > 0) ) return(extra_values[j]);
+    std::cout << "FAILURE: parameter not found in settings file: " << key << std::endl;
+    exit(EXIT_FAILURE);
+}
+
+double Sweep::param (long long i, const std::string &key) const {
+    return( std::atof(value(i, key).c_str()) );
+}
+
+Settings Sweep::trial (long long i) const {
+    Settings s = base;
+    std::vector<long> idx = decode(i);
+    for (unsigned long j=0; j<params.size(); j++)
+        if ( params[j].setting )
+            assign_setting(s, params[j].key.c_str(), params[j].values[idx[j]].c_str());
+    return(s);
+}
+
+void Sweep::write_table (const std::string &fn) const {
+
+    check_file_write(fn.c_str());
+    FILE *ofile = fopen(fn.c_str(), "w");
+    //header
+    fprintf(ofile, "trial");
+    for (unsigned long j=0; j<params.size(); j++) fprintf(ofile, ",%s", params[j].key.c_str());
+    fprintf(ofile, "\n");
+    //a row for each trial
+    for (long long i=0; i<ntrial; i++) {
+        std::vector<long> idx = decode(i);
+        fprintf(ofile, "%lli", i);
+        for (unsigned long j=0; j<params.size(); j++) write_cell(ofile, params[j].values[idx[j]]);
+        fprintf(ofile, "\n");
+    }
+    fclose(ofile);
+}
+
+void Sweep::write_summary (const std::string &dirout, Archive *archive, Writer *writer) const {
+
+    std::string fn = dirout + "/summary.csv";
+    check_file_write(fn.c_str());
+    FILE *ofile = fopen(fn.c_str(), "w");
+    //header, the swept values of each trial and then its reductions
+    fprintf(ofile, "trial");
+    for (unsigned long j=0; j<params.size(); j++) fprintf(ofile, ",%s", params[j].key.c_str());
+    for (unsigned long j=0; j<columns.size(); j++) fprintf(ofile, ",%s", columns[j].c_str());
+    fprintf(ofile, "\n");
+    for (long long i=0; i<ntrial; i++) {
+        std::vector<long> idx = decode(i);
+        fprintf(ofile, "%lli", i);
+        for (unsigned long j=0; j<params.size(); j++) write_cell(ofile, params[j].values[idx[j]]);
+        for (unsigned long j=0; j<columns.size(); j++) fprintf(ofile, ",%.17g", summary[j][i]);
+        fprintf(ofile, "\n");
+    }
+    fclose(ofile);
+
+    //each column in binary, indexed by trial number
+    for (unsigned long j=0; j<columns.size(); j++)
+        write_output(archive, writer, dirout, "summary", columns[j], -1, NAN, summary[j].data(), long(ntrial));
+}
+
+void Sweep::run (const std::string &dirout,
+                 Archive *archive,
+                 Writer *writer,
+                 std::function<void(Heat&, long long)> setup_heat,
+                 std::function<void(HeatBatch&, long, long long)> setup_batch,
+                 std::function<void(HeatLinear&, long, long long)> setup_linear) {
+
+    //a single grid unless the grid is swept
+    bool shared_grid = true;
+    for (unsigned long j=0; j<grid_keys.size(); j++)
+        if ( varies(grid_keys[j]) ) shared_grid = false;
+    Grid grid(base.depth, base.delz0, base.delzfrac, base.delzmax);
+    if ( shared_grid && base.save_grid ) {
+        if ( archive ) grid.save(*archive);
+        else grid.save(dirout);
+    }
+
+    //a column of the summary table for each reduction, named by the reductions of the first trial
+    columns.clear();
+    summary.clear();
+    if ( !reducers.empty() ) {
+        Settings s0 = trial(0);
+        for (unsigned long j=0; j<reducers.size(); j++) {
+            std::string name = reducers[j](s0, 0).name;
+            for (unsigned long l=0; l<columns.size(); l++)
+                if ( columns[l] == name ) print_exit(("two reductions of a sweep are named " + name).c_str());
+            columns.push_back(name);
+        }
+        summary.assign(columns.size(), std::vector<double>(ntrial, NAN));
+    }
+    //registers the reductions of a trial with a solver
+    auto reduce = [&](const Settings &s, long long i, std::function<void(Reducer)> add) {
+        for (unsigned long j=0; j<reducers.size(); j++) add( reducers[j](s, i) );
+    };
+    //stores the results of a trial's reductions, which are registered first
+    auto collect = [&](long long i, const std::vector<Reducer> &r) {
+        for (unsigned long j=0; j<columns.size(); j++) summary[j][i] = r[j].result();
+    };
+
+    //finished trials of a killed sweep are skipped when checkpointing,
+    //and their reductions are read back from the manifest
+    std::unique_ptr<Manifest> manifest;
+    if ( base.checkpoint > 0 ) {
+        manifest.reset(new Manifest(dirout + "/manifest"));
+        if ( manifest->get_nfinished() > 0 )
+            printf("%lli trials already finished\n", manifest->get_nfinished());
+        for (long long i=0; (i<ntrial) && !columns.empty(); i++) {
+            std::vector<double> row = manifest->row(i);
+            if ( row.size() == columns.size() )
+                for (unsigned long j=0; j<columns.size(); j++) summary[j][i] = row[j];
+        }
+    }
+    auto finished = [&](long long i) { return( manifest && manifest->finished(i) ); };
+    //output has to be on disk before a trial is recorded as finished
+    auto finish = [&](long long i) {
+        if ( !manifest ) return;
+        if ( writer ) writer->flush();
+        if ( archive ) archive->flush();
+        std::vector<double> row;
+        for (unsigned long j=0; j<columns.size(); j++) row.push_back( summary[j][i] );
+        manifest->finish(i, row);
+    };
+
+    //performance counters of every trial, if compiled in
+    TelemetryLog telemetry;
+
+    //whether each swept parameter is superposed, and the number of trials superposed together
+    std::vector<bool> superposed(params.size(), false);
+    long long nsup = 1;
+    for (unsigned long j=0; j<params.size(); j++) {
+        for (unsigned long l=0; l<linear_keys.size(); l++)
+            if ( params[j].key == linear_keys[l] ) superposed[j] = true;
+        if ( superposed[j] ) nsup *= (long long)params[j].values.size();
+    }
+    bool linear = (nsup > 1) && HeatLinear::linear(base) && (setup_linear || (!setup_heat && !setup_batch));
+    for (unsigned long l=0; l<nonlinear_keys.size(); l++)
+        if ( varies(nonlinear_keys[l]) ) linear = false;
+
+    printf("beginning %lli trials with %d threads\n", ntrial, omp_get_max_threads());
+    if ( linear ) {
+        //groups of trials differing only in superposed settings
+        long long ngroup = ntrial/nsup;
+        printf("%lli groups of %lli superposed trials\n", ngroup, nsup);
+        //number of a group's trial, with the group's digits on the other parameters
+        auto group_trial = [&](long long g, long long j) {
+            long long i = 0, place = 1, m, d;
+            for (long p=long(params.size())-1; p>=0; p--) {
+                m = (long long)params[p].values.size();
+                if ( superposed[p] ) {
+                    d = j % m;
+                    j /= m;
+                } else {
+                    d = g % m;
+                    g /= m;
+                }
+                i += d*place;
+                place *= m;
+            }
+            return(i);
+        };
+        auto group_settings = [&](long long g) {
+            std::vector<Settings> stgs;
+            for (long long j=0; j<nsup; j++)
+                stgs.push_back( trial(group_trial(g, j)) );
+            return(stgs);
+        };
+        //a group is only skipped if all of its trials are finished
+        auto group_finished = [&](long long g) {
+            for (long long j=0; j<nsup; j++)
+                if ( !finished(group_trial(g, j)) ) return(false);
+            return(true);
+        };
+        auto group_grid = [&](const Settings &s) {
+            return( shared_grid ? grid : Grid(s.depth, s.delz0, s.delzfrac, s.delzmax) );
+        };
+        //predict the cost of each group
+        Scheduler sched(ngroup);
+        for (long long g=0; g<ngroup; g++) {
+            if ( group_finished(g) ) {
+                sched.set_cost(g, 0.0);
+                continue;
+            }
+            std::vector<Settings> stgs = group_settings(g);
+            sched.set_cost(g, HeatLinear(group_grid(stgs[0]), stgs).cost_units(stgs[0].tint*stgs[0].tunit));
+        }
+        sched.set_progress(base.progress);
+        //integrate, longest first
+        sched.run([&](long g) {
+            if ( group_finished(g) ) return;
+            std::vector<Settings> stgs = group_settings(g);
+            HeatLinear lin(group_grid(stgs[0]), stgs);
+            lin.set_quiet(true);
+            lin.set_archive(archive);
+            lin.set_writer(writer);
+            for (long w=0; w<lin.ntrial; w++) {
+                long long i = group_trial(g, w);
+                lin.set_name(w, int_to_string(i));
+                //trials with their own grid write its cell coordinates
+                if ( !shared_grid && stgs[w].save_grid && stgs[w].trial_files ) {
+                    GridView zc = lin.grid.get_zc();
+                    write_output(archive, writer, dirout, lin.get_name(w), "zc", -1, NAN, zc.data(), zc.size());
+                }
+                reduce(stgs[w], i, [&](Reducer r) { lin.add_reducer(w, r); });
+                if ( setup_linear ) setup_linear(lin, w, i);
+            }
+            lin.solve(stgs[0].tint*stgs[0].tunit, stgs[0].nsnap, dirout.c_str());
+            telemetry.add(group_trial(g, 0), lin.ntrial, omp_get_thread_num(), lin.tel);
+            for (long w=0; w<lin.ntrial; w++) {
+                collect(group_trial(g, w), lin.trials[w].reducers);
+                finish(group_trial(g, w));
+            }
+        });
+        sched.print_report();
+        sched.write_report(dirout + "/schedule.csv");
+    } else if ( !base.implicit && !base.rkc && !base.radiative && !base.enthalpy && !base.adaptive && (base.nlevel == 1) && varies_only(lane_keys)
+                && (setup_batch || !setup_heat) ) {
+        //batches of up to NLANE trials with the same diffusivity, so every lane takes the stable step
+        //it would take alone, formed in order of diffusivity so that few batches are left partly empty
+        std::vector<double> diff(ntrial);
+        std::vector<long long> order(ntrial);
+        for (long long i=0; i<ntrial; i++) {
+            Settings s = trial(i);
+            diff[i] = s.k0/(s.rho0*s.c0);
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](long long i, long long j) { return(diff[i] < diff[j]); });
+        //positions in order where each batch starts, with the end of the last one
+        std::vector<long long> first;
+        for (long long i=0; i<ntrial; i++)
+            if ( first.empty() || (i - first.back() == NLANE) || (diff[order[i]] != diff[order[first.back()]]) )
+                first.push_back(i);
+        long long nbatch = (long long)first.size();
+        first.push_back(ntrial);
+        printf("%lli batches of up to %d trials\n", nbatch, NLANE);
+        //trial in lane w of batch b
+        auto batch_trial = [&](long long b, long w) {
+            return( order[first[b] + w] );
+        };
+        auto batch_settings = [&](long long b) {
+            std::vector<Settings> stgs;
+            for (long long i=first[b]; i<first[b+1]; i++)
+                stgs.push_back( trial(order[i]) );
+            return(stgs);
+        };
+        //a batch is only skipped if all of its trials are finished
+        auto batch_finished = [&](long long b) {
+            for (long long i=first[b]; i<first[b+1]; i++)
+                if ( !finished(order[i]) ) return(false);
+            return(true);
+        };
+        //predict the cost of each batch, which depends on its smallest stable step
+        Scheduler sched(nbatch);
+        for (long long b=0; b<nbatch; b++)
+            if ( !batch_finished(b) )
+                sched.set_cost(b, HeatBatch(grid, batch_settings(b)).cost_units(base.tint*base.tunit));
+            else
+                sched.set_cost(b, 0.0);
+        sched.set_progress(base.progress);
+        //integrate, longest first
+        sched.run([&](long b) {
+            if ( batch_finished(b) ) return;
+            HeatBatch batch(grid, batch_settings(b));
+            batch.set_archive(archive);
+            batch.set_writer(writer);
+            for (long w=0; w<batch.nact; w++) {
+                batch.set_name(w, int_to_string(batch_trial(b, w)));
+                reduce(batch.stg[w], batch_trial(b, w), [&](Reducer r) { batch.add_reducer(w, r); });
+                if ( setup_batch ) setup_batch(batch, w, batch_trial(b, w));
+            }
+            batch.solve(base.tint*base.tunit, base.nsnap, dirout.c_str());
+            telemetry.add(batch_trial(b, 0), batch.nact, omp_get_thread_num(), batch.tel);
+            for (long w=0; w<batch.nact; w++) {
+                collect(batch_trial(b, w), batch.reducers[w]);
+                finish(batch_trial(b, w));
+            }
+        });
+        sched.print_report();
+        sched.write_report(dirout + "/schedule.csv");
+    } else {
+        //one solver for each thread, reset for each of its trials and only
+        //reconstructed when a trial's grid differs from the last one
+        SolverPool<Heat> pool;
+        //predict the cost of each trial
+        Scheduler sched(ntrial);
+        for (long long i=0; i<ntrial; i++) {
+            if ( finished(i) ) {
+                sched.set_cost(i, 0.0);
+                continue;
+            }
+            Settings stgi = trial(i);
+            Heat &heat = pool.acquire(stgi.depth, stgi.delz0, stgi.delzfrac, stgi.delzmax, stgi);
+            sched.set_cost(i, heat.cost_units(stgi.tint*stgi.tunit));
+        }
+        sched.set_progress(base.progress);
+        //integrate, longest first
+        sched.run([&](long i) {
+            if ( finished(i) ) return;
+            Settings stgi = trial(i);
+            Heat &heat = pool.acquire(stgi.depth, stgi.delz0, stgi.delzfrac, stgi.delzmax, stgi);
+            heat.set_quiet(true);
+            heat.set_name(int_to_string(i));
+            heat.set_archive(archive);
+            heat.set_writer(writer);
+            //trials with their own grid write its cell coordinates
+            if ( !shared_grid && stgi.save_grid && stgi.trial_files ) {
+                GridView zc = heat.grid.get_zc();
+                write_output(archive, writer, dirout, heat.get_name(), "zc", -1, NAN, zc.data(), zc.size());
+            }
+            reduce(stgi, i, [&](Reducer r) { heat.add_reducer(r); });
+            if ( setup_heat ) setup_heat(heat, i);
+            heat.solve(stgi.tint*stgi.tunit, stgi.nsnap, dirout.c_str());
+            telemetry.add(i, 1, omp_get_thread_num(), heat.tel);
+            collect(i, heat.reducers);
+            finish(i);
+        });
+        sched.print_report();
+        sched.write_report(dirout + "/schedule.csv");
+    }
+    if ( TelemetryLog::enabled() ) {
+        telemetry.write_trials(dirout + "/telemetry_trials.csv");
+        telemetry.write_threads(dirout + "/telemetry_threads.csv");
+    }
+    if ( !columns.empty() ) {
+        write_summary(dirout, archive, writer);
+        printf("summary of %lu reductions written to: %s/summary.csv\n", columns.size(), dirout.c_str());
+    }
+    printf("all trials complete\n");
+}
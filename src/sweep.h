@@ -0,0 +1,129 @@
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+//! \file sweep.h
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <functional>
+
+#include "io.h"
+#include "util.h"
+#include "grid.h"
+#include "heat.h"
+#include "writer.h"
+#include "reducer.h"
+#include "archive.h"
+#include "settings.h"
+#include "checkpoint.h"
+#include "pool.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "heat_batch.h"
+#include "heat_linear.h"
+
+//!a parameter varied by a Sweep
+struct SweepParam {
+    //!name of the parameter in the settings file
+    std::string key;
+    //!text values the parameter takes
+    std::vector<std::string> values;
+    //!whether the parameter is a field of Settings, rather than a driver parameter
+    bool setting;
+};
+
+//!parameter sweep over the Cartesian product of values given in a settings file
+/*!
+Any setting in the registry of Settings fields may be given a range or list of values instead of a single value:
+    - `lin(a, b, n)` for n evenly spaced values from a to b, like linspace
+    - `log(a, b, n)` for n logarithmically spaced values from 10^a to 10^b, like logspace
+    - `list(v1, v2, ...)` for the values given
+
+A trial is run for every combination of values. Trials are numbered with the last swept setting in the file varying fastest, so the first swept setting is the outermost loop. Trials are generated one at a time from their number, so the table of all combinations is never stored.
+
+Drivers may also declare parameters that aren't Settings fields (extra keys), which are given in the settings file in the same way, fixed or swept, and read with param().
+
+Reductions registered with add_reducer are computed for every trial during its integration (see Reducer) and collected into a summary table, one column for each reduction and one row for each trial, which is written once when the sweep finishes. When the answers of a sweep are all in the table, the `trial_files` setting can be turned off so that trials write no files of their own.
+*/
+class Sweep {
+public:
+
+    //!constructs
+    /*!
+    \param[in] sv vector of vectors of strings from read_values()
+    \param[in] extra names of driver parameters that aren't Settings fields
+    */
+    Sweep (std::vector< std::vector< std::string > > sv, std::vector<std::string> extra=std::vector<std::string>());
+
+    //!settings shared by every trial (the fixed values in the settings file)
+    Settings base;
+    //!swept parameters, in the order they appear in the settings file
+    std::vector<SweepParam> params;
+
+    //!total number of trials
+    long long get_ntrial () const { return(ntrial); }
+    //!whether a parameter is swept
+    bool varies (const std::string &key) const;
+    //!whether no Settings fields are swept except the ones given
+    bool varies_only (const std::vector<std::string> &keys) const;
+    //!text value of a swept parameter or a driver parameter in a trial
+    std::string value (long long i, const std::string &key) const;
+    //!numerical value of a swept parameter or a driver parameter in a trial
+    double param (long long i, const std::string &key) const;
+    //!generates the settings of a trial
+    Settings trial (long long i) const;
+    //!writes a csv table with the swept values of every trial, one row at a time
+    void write_table (const std::string &fn) const;
+
+    //!registers a reduction of every trial, made for each trial by a function of its settings and number, which must give it the same name every time
+    void add_reducer (std::function<Reducer(const Settings&, long long)> make) { reducers.push_back(make); }
+    //!registers the same reduction of every trial
+    void add_reducer (Reducer r) { reducers.push_back( [r](const Settings &s, long long i) { (void)s; (void)i; return(r); } ); }
+    //!names of the summary table's columns, one for each reduction, once run has started
+    const std::vector<std::string> &get_columns () const { return(columns); }
+    //!result of a reduction of a trial, once run has finished, or NAN if the trial wasn't integrated
+    double get_summary (long long i, long j) const { return(summary[j][i]); }
+
+    //!integrates every trial with HeatLinear, HeatBatch, or Heat, in parallel, writing output into dirout
+    /*!
+    If the problem is linear (see HeatLinear) and Tsa, Tsb, or qgeo0 are swept, trials that differ only in those settings are integrated together by a HeatLinear, which integrates one response for all of them. This path is only taken if setup_linear is given or neither of the other setup functions is, so that a driver's setup isn't skipped. Otherwise, trials are integrated with HeatBatch, up to NLANE trials at a time, if the single-rate, fixed-step explicit temperature solver and the fixed surface temperature are used and only the parameters allowed to differ between lanes (see HeatBatch) are swept, and setup_batch is given or setup_heat isn't, again so that a driver's setup isn't skipped. Only trials with the same diffusivity, k0/(rho0*c0), share a batch, so every lane takes the stable time step it would take alone, and they're batched in order of diffusivity so few batches are left partly empty. Otherwise trials are integrated with Heat objects from a SolverPool, one per thread, which are reset for each trial and only reconstructed, with a new grid, when grid settings are swept. Output is named by trial number. The results of registered reductions are collected for every trial and written to dirout/summary.csv, with the swept values of each trial, and to a binary output variable for each reduction, named summary_<reduction> (or in the archive). The cost of each trial (or batch) is predicted from its grid, stable time step, and duration, and they're run longest first by a Scheduler, which writes its predicted and actual costs to schedule.csv. When the `checkpoint` setting is positive, finished trials are recorded in dirout/manifest, with their reductions, and skipped if the sweep is run again, and trials in progress resume from their checkpoints. When compiled with -DTELEMETRY, the counters of every trial (or batch) and thread are written to telemetry_trials.csv and telemetry_threads.csv.
+    \param[in] dirout output directory
+    \param[in] archive archive for all output, or NULL
+    \param[in] writer background writer, or NULL
+    \param[in] setup_heat optional function called with each Heat object and its trial number before integrating
+    \param[in] setup_batch optional function called with each HeatBatch, each lane, and the lane's trial number before integrating
+    \param[in] setup_linear optional function called with each HeatLinear, each of its trials, and the trial's number before integrating
+    */
+    void run (const std::string &dirout,
+              Archive *archive=NULL,
+              Writer *writer=NULL,
+              std::function<void(Heat&, long long)> setup_heat=NULL,
+              std::function<void(HeatBatch&, long, long long)> setup_batch=NULL,
+              std::function<void(HeatLinear&, long, long long)> setup_linear=NULL);
+
+private:
+
+    //!total number of trials
+    long long ntrial;
+    //!names of driver parameters that aren't Settings fields
+    std::vector<std::string> extra;
+    //!fixed values of driver parameters, empty if not given or swept
+    std::vector<std::string> extra_values;
+
+    //!functions making the registered reductions of a trial
+    std::vector< std::function<Reducer(const Settings&, long long)> > reducers;
+    //!name of each reduction
+    std::vector<std::string> columns;
+    //!result of each reduction (outer) for each trial (inner)
+    std::vector< std::vector<double> > summary;
+
+    //!index of a value of each swept parameter in a trial
+    std::vector<long> decode (long long i) const;
+    //!writes the summary table as csv and as binary output
+    void write_summary (const std::string &dirout, Archive *archive, Writer *writer) const;
+};
+
+#endif
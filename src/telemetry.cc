@@ -0,0 +1,59 @@
+//! \file telemetry.cc
+
+#include "telemetry.h"
+
+bool TelemetryLog::enabled () {
+#ifdef TELEMETRY
+    return(true);
+#else
+    return(false);
+#endif
+}
+
+void TelemetryLog::add (long long trial, long ntrial, int thread, const Telemetry &tel) {
+    std::lock_guard<std::mutex> guard(lock);
+    records.push_back({trial, ntrial, thread, tel});
+}
+
+void TelemetryLog::write_trials (const std::string &fn) {
+    std::lock_guard<std::mutex> guard(lock);
+    check_file_write(fn.c_str());
+    FILE *ofile = fopen(fn.c_str(), "w");
+    fprintf(ofile, "trial,ntrial,thread,steps,cell updates,picard,newton,bytes,construct (s),solve (s),write (s)\n");
+    for (unsigned long j=0; j<records.size(); j++) {
+        const Record &r = records[j];
+        fprintf(ofile, "%lli,%li,%d,%li,%li,%li,%li,%li,%g,%g,%g\n",
+            r.trial, r.ntrial, r.thread, r.tel.nstep, r.tel.ncell, r.tel.npicard, r.tel.nnewton, r.tel.nbyte,
+            r.tel.tconstruct, r.tel.tsolve - r.tel.twrite, r.tel.twrite);
+    }
+    fclose(ofile);
+}
+
+void TelemetryLog::write_threads (const std::string &fn) {
+    std::lock_guard<std::mutex> guard(lock);
+    //totals of each thread, with the trial count in ntrial
+    std::map<int,Record> tot;
+    for (unsigned long j=0; j<records.size(); j++) {
+        const Record &r = records[j];
+        Record &s = tot[r.thread];
+        s.ntrial += r.ntrial;
+        s.tel.nstep += r.tel.nstep;
+        s.tel.ncell += r.tel.ncell;
+        s.tel.npicard += r.tel.npicard;
+        s.tel.nnewton += r.tel.nnewton;
+        s.tel.nbyte += r.tel.nbyte;
+        s.tel.tconstruct += r.tel.tconstruct;
+        s.tel.tsolve += r.tel.tsolve;
+        s.tel.twrite += r.tel.twrite;
+    }
+    check_file_write(fn.c_str());
+    FILE *ofile = fopen(fn.c_str(), "w");
+    fprintf(ofile, "thread,trials,steps,cell updates,picard,newton,bytes,construct (s),solve (s),write (s)\n");
+    for (auto it=tot.begin(); it!=tot.end(); it++) {
+        const Record &s = it->second;
+        fprintf(ofile, "%d,%li,%li,%li,%li,%li,%li,%g,%g,%g\n",
+            it->first, s.ntrial, s.tel.nstep, s.tel.ncell, s.tel.npicard, s.tel.nnewton, s.tel.nbyte,
+            s.tel.tconstruct, s.tel.tsolve - s.tel.twrite, s.tel.twrite);
+    }
+    fclose(ofile);
+}
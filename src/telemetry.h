@@ -0,0 +1,89 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+//! \file telemetry.h
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "io.h"
+
+//!performance counters of one integration (or one batch of integrations)
+/*!
+The counters are only filled in when the code is compiled with -DTELEMETRY, through the TELEMETRY_COUNT and TELEMETRY_TIME macros, which otherwise compile to nothing. Each Heat or HeatBatch object owns its counters and is integrated by one thread, so they're updated without locks.
+*/
+struct Telemetry {
+    //!number of accepted time steps
+    long nstep = 0;
+    //!number of cell updates, cells times right-hand side evaluations as in Heat::cost_units, so that multirate steps count each level's cells at the rate they're stepped
+    long ncell = 0;
+    //!number of Picard iterations of the implicit solver
+    long npicard = 0;
+    //!number of Newton iterations of surface temperature solves
+    long nnewton = 0;
+    //!number of bytes of output
+    long nbyte = 0;
+    //!time spent constructing (s)
+    double tconstruct = 0.0;
+    //!time spent solving, including writing (s)
+    double tsolve = 0.0;
+    //!time spent writing, or handing output to a background writer (s)
+    double twrite = 0.0;
+};
+
+//!adds time to an accumulator when it goes out of scope
+class TelemetryTimer {
+public:
+    //!starts timing
+    TelemetryTimer (double &acc_) : acc (acc_), t0 (std::chrono::steady_clock::now()) {}
+    //!adds the elapsed time to the accumulator
+    ~TelemetryTimer () { acc += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); }
+private:
+    double &acc;
+    std::chrono::steady_clock::time_point t0;
+};
+
+#ifdef TELEMETRY
+//!adds to a telemetry counter
+#define TELEMETRY_COUNT(counter, x) ((counter) += (x))
+//!adds the time until the end of the enclosing scope to a telemetry accumulator
+#define TELEMETRY_TIME(acc) TelemetryTimer telemetry_timer_(acc)
+#else
+#define TELEMETRY_COUNT(counter, x) ((void)0)
+#define TELEMETRY_TIME(acc) ((void)0)
+#endif
+
+//!collects the telemetry of every trial in a run and writes it as csv files
+class TelemetryLog {
+public:
+    //!whether the code was compiled with telemetry
+    static bool enabled ();
+    //!records the telemetry of a finished trial or batch, safe to call from multiple threads
+    /*!
+    \param[in] trial number of the (first) trial
+    \param[in] ntrial number of trials integrated together, more than one for batches
+    \param[in] thread thread that integrated them
+    \param[in] tel their counters
+    */
+    void add (long long trial, long ntrial, int thread, const Telemetry &tel);
+    //!writes a csv with a line for every trial or batch
+    void write_trials (const std::string &fn);
+    //!writes a csv with the totals of every thread
+    void write_threads (const std::string &fn);
+private:
+    //!telemetry of a trial or batch
+    struct Record {
+        long long trial = 0;
+        long ntrial = 0;
+        int thread = 0;
+        Telemetry tel;
+    };
+    std::vector<Record> records;
+    std::mutex lock;
+};
+
+#endif
@@ -0,0 +1,80 @@
+//! \file tracker.cc
+
+#include "tracker.h"
+
+Tracker::Tracker (long nmax_, TrackerMode mode_) {
+    mode = mode_;
+    reset(nmax_);
+}
+
+void Tracker::reset (long nmax_) {
+    //an even number of values, so full buffers merge in pairs
+    nmax = nmax_ < 2 ? 2 : nmax_ - nmax_ % 2;
+    buf.reserve(nmax);
+    clear();
+}
+
+double Tracker::reduce (double a, double b) const {
+    switch ( mode ) {
+        case tracker_min:
+            return( b < a ? b : a );
+        case tracker_max:
+            return( b > a ? b : a );
+        default:
+            return( b );
+    }
+}
+
+void Tracker::push (double x) {
+    //fold the sample into the current bucket
+    acc = count == 0 ? x : reduce(acc, x);
+    count++;
+    //store the bucket when it's full
+    if ( count == stride ) {
+        buf.push_back( acc );
+        count = 0;
+        //merge neighboring buckets when the buffer is full
+        if ( long(buf.size()) == nmax ) {
+            for (long i=0; i<nmax/2; i++)
+                buf[i] = reduce(buf[2*i], buf[2*i+1]);
+            buf.resize(nmax/2);
+            stride *= 2;
+        }
+    }
+}
+
+std::vector<double> Tracker::values () const {
+    std::vector<double> v(buf);
+    if ( count > 0 ) v.push_back( acc );
+    return(v);
+}
+
+void Tracker::clear () {
+    buf.clear();
+    stride = 1;
+    count = 0;
+    acc = 0.0;
+}
+
+void Tracker::save (CheckpointWriter &ck) const {
+    ck.put(nmax);
+    ck.put(long(mode));
+    ck.put(stride);
+    ck.put(count);
+    ck.put(acc);
+    ck.put(buf);
+}
+
+bool Tracker::load (CheckpointReader &ck) {
+    long stride_, count_;
+    double acc_;
+    std::vector<double> buf_;
+    if ( !ck.expect(nmax) || !ck.expect(long(mode)) ) return(false);
+    if ( !ck.get(stride_) || !ck.get(count_) || !ck.get(acc_) || !ck.get(buf_) ) return(false);
+    if ( long(buf_.size()) >= nmax ) return(false);
+    stride = stride_;
+    count = count_;
+    acc = acc_;
+    buf = buf_;
+    return(true);
+}
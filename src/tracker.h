@@ -0,0 +1,70 @@
+#ifndef TRACKER_H_
+#define TRACKER_H_
+
+//! \file tracker.h
+
+#include <vector>
+
+#include "checkpoint.h"
+
+//!how a Tracker reduces the samples that fall into one bucket
+enum TrackerMode {
+    //!keep the last sample of each bucket
+    tracker_last,
+    //!keep the smallest sample of each bucket
+    tracker_min,
+    //!keep the largest sample of each bucket
+    tracker_max
+};
+
+//!records a value at every step in a fixed amount of memory
+/*!
+Samples are reduced into buckets of `stride` consecutive samples, each stored as one value. When the buffer fills up, neighboring buckets are merged and the stride doubles, so no more than `nmax` values are ever stored, however many samples are pushed. Trackers pushed in lockstep share their bucket boundaries, so their values line up with each other. Minimum and maximum trackers keep the extremes of each bucket instead of a sample from it, so no extreme value is lost.
+*/
+class Tracker {
+public:
+
+    //!constructs
+    /*!
+    \param[in] nmax maximum number of stored values (rounded down to an even number, at least 2)
+    \param[in] mode how samples in a bucket are reduced
+    */
+    Tracker (long nmax=100, TrackerMode mode=tracker_last);
+
+    //!adds a sample
+    void push (double x);
+    //!gets the stored values, including the partially filled last bucket
+    std::vector<double> values () const;
+    //!gets the number of stored values, including the partially filled last bucket
+    long size () const { return( long(buf.size()) + (count > 0 ? 1 : 0) ); }
+    //!gets the number of samples in each full bucket
+    long get_stride () const { return(stride); }
+    //!removes all samples
+    void clear ();
+    //!removes all samples and changes the maximum number of stored values, keeping the buffer's memory if it's large enough
+    void reset (long nmax);
+    //!writes the tracker's state to a checkpoint
+    void save (CheckpointWriter &ck) const;
+    //!restores the tracker's state from a checkpoint, returning false if it doesn't match this tracker
+    bool load (CheckpointReader &ck);
+
+private:
+
+    //!maximum number of stored values
+    long nmax;
+    //!reduction mode
+    TrackerMode mode;
+    //!number of samples per bucket
+    long stride;
+    //!number of samples in the current bucket
+    long count;
+    //!reduced value of the current bucket
+    double acc;
+    //!values of full buckets
+    std::vector<double> buf;
+
+    //!reduces two values according to the mode
+    double reduce (double a, double b) const;
+};
+
+#endif
@@ -22,7 +22,7 @@ double min (double *a, long n) {
     return(r);
 }
 
-double interp (double *x, double *y, double xx, long n) {
+double interp (const double *x, const double *y, double xx, long n) {
 
     if ( xx <= x[0] )
         return(y[0]);
@@ -32,6 +32,92 @@ double interp (double *x, double *y, double xx, long n) {
     return(y[n-1]);
 }
 
+void solve_tridiag (double *l, double *d, double *u, double *r, long n) {
+
+    long i;
+    double w;
+    //forward elimination
+    for (i=1; i<n; i++) {
+        w = l[i]/d[i-1];
+        d[i] -= w*u[i-1];
+        r[i] -= w*r[i-1];
+    }
+    //back substitution
+    r[n-1] /= d[n-1];
+    for (i=n-2; i>=0; i--)
+        r[i] = (r[i] - u[i]*r[i+1])/d[i];
+}
+
+long gmres (std::function<void(const double*, double*)> A, const double *b, double *x, long n, long m, double tol) {
+
+    long i, j, k, nprod;
+    double beta, h, r;
+    bool breakdown;
+    //Arnoldi vectors, columns of the rotated Hessenberg matrix, rotations, and the rotated right hand side
+    std::vector< std::vector<double> > V(1, std::vector<double>(b, b + n));
+    std::vector< std::vector<double> > R;
+    std::vector<double> cs, sn, g;
+
+    for (i=0; i<n; i++) x[i] = 0.0;
+    beta = 0.0;
+    for (i=0; i<n; i++) beta += b[i]*b[i];
+    beta = sqrt(beta);
+    if ( beta == 0.0 ) return(0);
+    for (i=0; i<n; i++) V[0][i] /= beta;
+    g.push_back( beta );
+
+    for (nprod=0; nprod<m; ) {
+        j = nprod;
+        //next Krylov vector, orthogonalized against the others
+        V.push_back( std::vector<double>(n) );
+        std::vector<double> &w = V[j+1];
+        A(V[j].data(), w.data());
+        nprod++;
+        R.push_back( std::vector<double>(j+2) );
+        std::vector<double> &c = R[j];
+        for (k=0; k<=j; k++) {
+            h = 0.0;
+            for (i=0; i<n; i++) h += w[i]*V[k][i];
+            for (i=0; i<n; i++) w[i] -= h*V[k][i];
+            c[k] = h;
+        }
+        h = 0.0;
+        for (i=0; i<n; i++) h += w[i]*w[i];
+        c[j+1] = sqrt(h);
+        //the Krylov space is invariant, so the solution is in it
+        breakdown = c[j+1] <= 1e-14*beta;
+        if ( !breakdown )
+            for (i=0; i<n; i++) w[i] /= c[j+1];
+        //apply the earlier rotations to the new column, then zero its last entry
+        for (k=0; k<j; k++) {
+            h = cs[k]*c[k] + sn[k]*c[k+1];
+            c[k+1] = -sn[k]*c[k] + cs[k]*c[k+1];
+            c[k] = h;
+        }
+        r = sqrt(c[j]*c[j] + c[j+1]*c[j+1]);
+        cs.push_back( c[j]/r );
+        sn.push_back( c[j+1]/r );
+        c[j] = r;
+        c[j+1] = 0.0;
+        g.push_back( -sn[j]*g[j] );
+        g[j] *= cs[j];
+        //the residual is |g[j+1]|
+        if ( breakdown || (fabs(g[j+1]) <= tol*beta) ) break;
+    }
+
+    //back substitution for the coefficients of the Krylov vectors, then the solution
+    std::vector<double> y(nprod);
+    for (j=nprod-1; j>=0; j--) {
+        h = g[j];
+        for (k=j+1; k<nprod; k++) h -= R[k][j]*y[k];
+        y[j] = h/R[j][j];
+    }
+    for (j=0; j<nprod; j++)
+        for (i=0; i<n; i++) x[i] += y[j]*V[j][i];
+
+    return(nprod);
+}
+
 std::vector<double> linspace (double a, double b, long n) {
 
     //avoid division by zero
@@ -74,7 +160,7 @@ std::vector<double> logspace (double a, double b, long n) {
     return(v);
 }
 
-std::vector<double> subsample (std::vector<double> v, unsigned long n) {
+std::vector<double> subsample (const std::vector<double> &v, unsigned long n) {
 
     //calculate the approximate interval size
     unsigned long size = v.size();
@@ -7,6 +7,7 @@
 #include <vector>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
 
 //!finds max of array
 double max (double *a, long n);
@@ -15,7 +16,30 @@ double max (double *a, long n);
 double min (double *a, long n);
 
 //!interpolates a 1d array
-double interp (double *x, double *y, double xx, long n);
+double interp (const double *x, const double *y, double xx, long n);
+
+//!solves a tridiagonal system of equations with the Thomas algorithm
+/*!
+\param[in] l sub-diagonal, l[0] is ignored
+\param[in,out] d diagonal, overwritten
+\param[in] u super-diagonal, u[n-1] is ignored
+\param[in,out] r right hand side, overwritten with the solution
+\param[in] n number of equations
+*/
+void solve_tridiag (double *l, double *d, double *u, double *r, long n);
+
+//!solves a linear system with GMRES, needing only products of the matrix with vectors
+/*!
+The iteration starts from zero and isn't restarted, so it stores a vector for each product. Arnoldi vectors are orthogonalized with modified Gram-Schmidt and the least squares problem is updated with Givens rotations.
+\param[in] A computes the product of the matrix with a vector, A(v, Av)
+\param[in] b right hand side
+\param[out] x solution
+\param[in] n number of equations
+\param[in] m maximum number of products
+\param[in] tol relative tolerance, stopping when |b - A*x| <= tol*|b| in the 2-norm
+\return number of products taken
+*/
+long gmres (std::function<void(const double*, double*)> A, const double *b, double *x, long n, long m, double tol);
 
 //!creates an evenly spaced vector of values over a range
 std::vector<double> linspace (double a, double b, long n);
@@ -28,6 +52,6 @@ std::vector<double> logspace (double a, double b, long n);
 \param[in] v vector to subsample
 \param[in] n approximate length target
 */
-std::vector<double> subsample (std::vector<double> v, unsigned long n);
+std::vector<double> subsample (const std::vector<double> &v, unsigned long n);
 
 #endif
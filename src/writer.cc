@@ -0,0 +1,175 @@
+//! \file writer.cc
+
+#include "writer.h"
+
+//!seconds elapsed since a time point
+static double seconds_since (std::chrono::steady_clock::time_point t0) {
+    return( std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() );
+}
+
+Writer::Writer (long nqueue_) {
+
+    nqueue = nqueue_;
+    if ( nqueue < 1 ) print_exit("Writer queue length must be at least 1");
+    busy = false;
+    stop = false;
+    nsubmit = 0;
+
+    //counters
+    nwrite = 0;
+    nbyte = 0.0;
+    twrite = 0.0;
+    nblock = 0;
+    tblock = 0.0;
+
+    //start writing
+    thread = std::thread(&Writer::run, this);
+}
+
+Writer::~Writer () {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    cv_job.notify_one();
+    thread.join();
+}
+
+std::vector<double> Writer::take_buffer (const double *a, long size) {
+    std::vector<double> buf;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if ( !pool.empty() ) {
+            buf.swap(pool.back());
+            pool.pop_back();
+        }
+    }
+    //copy outside the lock, reusing the buffer's memory
+    buf.assign(a, a + size);
+    return(buf);
+}
+
+void Writer::submit (WriterJob &job) {
+
+    std::unique_lock<std::mutex> guard(lock);
+    //wait for room in the queue
+    if ( long(queue.size()) >= nqueue ) {
+        auto t0 = std::chrono::steady_clock::now();
+        cv_done.wait(guard, [this]{ return( long(queue.size()) < nqueue ); });
+        nblock++;
+        tblock += seconds_since(t0);
+    }
+    queue.push_back(std::move(job));
+    nsubmit++;
+    guard.unlock();
+    cv_job.notify_one();
+}
+
+void Writer::write (const std::string &path, const double *a, long size) {
+    WriterJob job;
+    job.archive = NULL;
+    job.path = path;
+    job.data = take_buffer(a, size);
+    submit(job);
+}
+
+void Writer::append (Archive *archive, const std::string &name, const std::string &var, long isnap, double t, const double *a, long size) {
+    WriterJob job;
+    job.archive = archive;
+    job.name = name;
+    job.var = var;
+    job.isnap = isnap;
+    job.t = t;
+    job.data = take_buffer(a, size);
+    submit(job);
+}
+
+void Writer::flush () {
+    std::unique_lock<std::mutex> guard(lock);
+    //writes finish in the order they're submitted
+    long target = nsubmit;
+    cv_done.wait(guard, [this, target]{ return( nwrite >= target ); });
+}
+
+void Writer::run () {
+
+    WriterJob job;
+
+    while ( true ) {
+        //wait for a job, leaving once everything is written
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            cv_job.wait(guard, [this]{ return( !queue.empty() || stop ); });
+            if ( queue.empty() ) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+            busy = true;
+        }
+        //there's room in the queue now
+        cv_done.notify_all();
+
+        //write without holding the lock
+        auto t0 = std::chrono::steady_clock::now();
+        if ( job.archive != NULL ) {
+            job.archive->append(job.name, job.var, job.isnap, job.t, job.data.data(), long(job.data.size()));
+        } else {
+            write_double(job.path, job.data);
+        }
+        double dt = seconds_since(t0);
+
+        //count the write and recycle its buffer
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            nwrite++;
+            nbyte += double(job.data.size()*sizeof(double));
+            twrite += dt;
+            if ( long(pool.size()) <= nqueue ) pool.push_back(std::move(job.data));
+            busy = false;
+        }
+        job.data = std::vector<double>();
+        cv_done.notify_all();
+    }
+}
+
+void write_output (Archive *archive, Writer *writer, const std::string &dirout, const std::string &name, const std::string &var, long isnap, double t, const double *a, long size) {
+    if ( archive != NULL ) {
+        if ( writer != NULL ) writer->append(archive, name, var, isnap, t, a, size);
+        else archive->append(name, var, isnap, t, a, size);
+    } else {
+        std::string path = dirout + "/" + name + "_" + var;
+        if ( isnap >= 0 ) path += "_" + int_to_string(isnap);
+        if ( writer != NULL ) writer->write(path, a, size);
+        else write_double(path, a, size);
+    }
+}
+
+long Writer::get_nwrite () {
+    std::lock_guard<std::mutex> guard(lock);
+    return(nwrite);
+}
+
+double Writer::get_nbyte () {
+    std::lock_guard<std::mutex> guard(lock);
+    return(nbyte);
+}
+
+double Writer::get_twrite () {
+    std::lock_guard<std::mutex> guard(lock);
+    return(twrite);
+}
+
+long Writer::get_nblock () {
+    std::lock_guard<std::mutex> guard(lock);
+    return(nblock);
+}
+
+double Writer::get_tblock () {
+    std::lock_guard<std::mutex> guard(lock);
+    return(tblock);
+}
+
+void Writer::print_counters () {
+    std::lock_guard<std::mutex> guard(lock);
+    printf("background writer: %li writes, %g MB, %g s writing, %li blocked submits, %g s blocked\n",
+        nwrite, nbyte/1e6, twrite, nblock, tblock);
+}
@@ -0,0 +1,126 @@
+#ifndef WRITER_H_
+#define WRITER_H_
+
+//! \file writer.h
+
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include "io.h"
+#include "archive.h"
+
+//!one pending write held by a Writer
+struct WriterJob {
+    //!archive to append to, or NULL to write the file at path
+    Archive *archive;
+    //!output file path, if not appending to an archive
+    std::string path;
+    //!record name, if appending to an archive
+    std::string name;
+    //!record variable, if appending to an archive
+    std::string var;
+    //!record snap number, if appending to an archive
+    long isnap;
+    //!record snap time, if appending to an archive
+    double t;
+    //!values to write
+    std::vector<double> data;
+};
+
+//!writes output on a background thread so integrations don't wait on the filesystem
+/*!
+Writes are copied into pooled buffers and queued, then written in order by a single writer thread, either to separate files or into an Archive. The queue holds at most nqueue writes. When it's full, submitting threads block until the writer catches up, so memory use stays bounded when output is produced faster than the filesystem takes it. The time submitting threads spend blocked and the time the writer thread spends writing are counted, so a run can report whether it's limited by I/O.
+
+One Writer may be shared by every thread of a sweep. It must be destroyed (or flushed) before any Archive it writes into is closed. Flushing only waits for writes submitted before it, so one thread can flush its own output while others keep submitting.
+*/
+class Writer {
+public:
+
+    //!starts the writer thread
+    /*!
+    \param[in] nqueue maximum number of queued writes
+    */
+    Writer (long nqueue=256);
+    //!writes everything still queued and stops the writer thread
+    ~Writer ();
+
+    //!queues a binary file of doubles to write
+    void write (const std::string &path, const double *a, long size);
+    //!queues a record to append to an archive
+    void append (Archive *archive, const std::string &name, const std::string &var, long isnap, double t, const double *a, long size);
+    //!waits until every write submitted before the call is finished
+    void flush ();
+
+    //!number of writes finished
+    long get_nwrite ();
+    //!number of bytes written
+    double get_nbyte ();
+    //!total time spent by the writer thread writing (s)
+    double get_twrite ();
+    //!number of submits that blocked on a full queue
+    long get_nblock ();
+    //!total time spent by submitting threads blocked on a full queue (s)
+    double get_tblock ();
+    //!prints the counters
+    void print_counters ();
+
+private:
+
+    //!maximum number of queued writes
+    long nqueue;
+    //!queued writes
+    std::deque<WriterJob> queue;
+    //!buffers recycled from finished writes
+    std::vector< std::vector<double> > pool;
+    //!whether the writer thread is in the middle of a write
+    bool busy;
+    //!whether the writer thread should stop once the queue is empty
+    bool stop;
+
+    //!number of writes submitted
+    long nsubmit;
+
+    //counters
+    long nwrite;
+    double nbyte;
+    double twrite;
+    long nblock;
+    double tblock;
+
+    //!guards everything above
+    std::mutex lock;
+    //!signals the writer thread that a job is queued or it should stop
+    std::condition_variable cv_job;
+    //!signals submitting threads that the queue has room or is empty
+    std::condition_variable cv_done;
+    //!the writer thread
+    std::thread thread;
+
+    //!takes a buffer from the pool and fills it
+    std::vector<double> take_buffer (const double *a, long size);
+    //!queues a job, blocking while the queue is full
+    void submit (WriterJob &job);
+    //!writer thread loop
+    void run ();
+};
+
+//!writes one output variable, to an archive or to the file dirout/name_var (dirout/name_var_isnap for snaps), through a Writer if there is one
+/*!
+\param[in] archive archive to append to, or NULL to write a file for each variable
+\param[in] writer background writer, or NULL to write immediately
+\param[in] dirout output directory
+\param[in] name name of the integration
+\param[in] var variable name
+\param[in] isnap snap number, or -1 if the variable isn't a snap
+\param[in] t snap time
+\param[in] a values to write
+\param[in] size number of values
+*/
+void write_output (Archive *archive, Writer *writer, const std::string &dirout, const std::string &name, const std::string &var, long isnap, double t, const double *a, long size);
+
+#endif